@@ -1,6 +1,6 @@
 #include "aabb.h"
 #include <algorithm>
-#include "display_manager.h"
+#include "render_queue.h"
 
 AABB::AABB(Math::vec2 minP, Math::vec2 maxP) :
 	m_minP(minP),
@@ -17,7 +17,16 @@ AABB::~AABB()
 
 void AABB::render(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
 {
-	DisplayManager::set_rect(
+	render(*this, r, g, b, a);
+}
+
+void AABB::render(const AABB & prev, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+	// Interpolated from prev's position by the renderer
+	RenderQueue::rect_lerp(
+		RenderQueue::RL_DEBUG,
+		static_cast<int>(prev.m_minP.x),
+		static_cast<int>(prev.m_minP.y),
 		static_cast<int>(m_minP.x),
 		static_cast<int>(m_minP.y),
 		static_cast<int>(m_maxP.x - m_minP.x),
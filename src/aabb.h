@@ -13,6 +13,7 @@ public:
 	~AABB();
 
 	virtual void render(uint8_t r, uint8_t g, uint8_t b, uint8_t a = -1);
+	virtual void render(const AABB & prev, uint8_t r, uint8_t g, uint8_t b, uint8_t a = -1);
 
 	bool collidesXRight(const AABB & other) const;
 	bool collidesXLeft(const AABB & other) const;
@@ -0,0 +1,345 @@
+#include "blend.h"
+
+#if defined(BLEND_SSE2)
+#include <emmintrin.h>
+#endif
+
+#if defined(BLEND_AVX2)
+#include <immintrin.h>
+#endif
+
+namespace Blend
+{
+
+// ------------------------------------------------------------------------
+// -- SIMD HELPERS
+// ------------------------------------------------------------------------
+#if defined(BLEND_SSE2)
+// Exact floor(x / 255) on 16-bit lanes, x in range 0..255*255
+static inline __m128i div255_epu16(__m128i x)
+{
+	return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+}
+
+// Broadcast the alpha lane of two unpacked pixels to all four lanes
+static inline __m128i alpha_epu16(__m128i x)
+{
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xFF), 0xFF);
+}
+
+// Greyscale (max color component) on four ARGB pixels, alpha from amask
+static inline __m128i grey_epu32(__m128i p, __m128i amask)
+{
+	__m128i rgb = _mm_and_si128(p, _mm_set1_epi32(0x00FFFFFF));
+	__m128i c = _mm_max_epu8(rgb, _mm_srli_epi32(rgb, 8));
+	c = _mm_and_si128(_mm_max_epu8(c, _mm_srli_epi32(rgb, 16)), _mm_set1_epi32(0x000000FF));
+
+	return _mm_or_si128(_mm_or_si128(c, _mm_slli_epi32(c, 8)), _mm_or_si128(_mm_slli_epi32(c, 16), amask));
+}
+#endif
+
+#if defined(BLEND_AVX2)
+static inline __m256i div255_epu16(__m256i x)
+{
+	return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, _mm256_set1_epi16(1)), _mm256_srli_epi16(x, 8)), 8);
+}
+
+static inline __m256i grey_epu32(__m256i p, __m256i amask)
+{
+	__m256i rgb = _mm256_and_si256(p, _mm256_set1_epi32(0x00FFFFFF));
+	__m256i c = _mm256_max_epu8(rgb, _mm256_srli_epi32(rgb, 8));
+	c = _mm256_and_si256(_mm256_max_epu8(c, _mm256_srli_epi32(rgb, 16)), _mm256_set1_epi32(0x000000FF));
+
+	return _mm256_or_si256(_mm256_or_si256(c, _mm256_slli_epi32(c, 8)), _mm256_or_si256(_mm256_slli_epi32(c, 16), amask));
+}
+#endif
+
+// ------------------------------------------------------------------------
+// -- SPAN KERNELS
+// ------------------------------------------------------------------------
+void fill_span(int32_t * dst, size_t n, int32_t argb)
+{
+	size_t i = 0;
+
+#if defined(BLEND_AVX2)
+	__m256i v8 = _mm256_set1_epi32(argb);
+	for (; i + 8 <= n; i += 8)
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), v8);
+#endif
+#if defined(BLEND_SSE2)
+	__m128i v4 = _mm_set1_epi32(argb);
+	for (; i + 4 <= n; i += 4)
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), v4);
+#endif
+
+	for (; i < n; i++)
+		dst[i] = argb;
+}
+
+void blend_span(int32_t * dst, size_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+	size_t i = 0;
+
+	// Opaque fill does not need to read the destination
+	if (a == 255)
+	{
+		fill_span(dst, n, static_cast<int32_t>(0xFF000000 | (r << 16) | (g << 8) | b));
+		return;
+	}
+
+	// Pre-multiply the source color by alpha, 16-bit lanes in memory order b, g, r, a
+	const short ra = static_cast<short>(r * a);
+	const short ga = static_cast<short>(g * a);
+	const short ba = static_cast<short>(b * a);
+
+#if defined(BLEND_AVX2)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i src = _mm256_set_epi16(0, ra, ga, ba, 0, ra, ga, ba, 0, ra, ga, ba, 0, ra, ga, ba);
+		const __m256i ia = _mm256_set1_epi16(static_cast<short>(255 - a));
+		const __m256i rgb = _mm256_set1_epi32(0x00FFFFFF);
+		const __m256i amask = _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(a) << 24));
+
+		for (; i + 8 <= n; i += 8)
+		{
+			__m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+			__m256i lo = _mm256_unpacklo_epi8(p, zero);
+			__m256i hi = _mm256_unpackhi_epi8(p, zero);
+			lo = div255_epu16(_mm256_add_epi16(_mm256_mullo_epi16(lo, ia), src));
+			hi = div255_epu16(_mm256_add_epi16(_mm256_mullo_epi16(hi, ia), src));
+			p = _mm256_or_si256(_mm256_and_si256(_mm256_packus_epi16(lo, hi), rgb), amask);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), p);
+		}
+	}
+#endif
+#if defined(BLEND_SSE2)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i src = _mm_set_epi16(0, ra, ga, ba, 0, ra, ga, ba);
+		const __m128i ia = _mm_set1_epi16(static_cast<short>(255 - a));
+		const __m128i rgb = _mm_set1_epi32(0x00FFFFFF);
+		const __m128i amask = _mm_set1_epi32(static_cast<int>(static_cast<uint32_t>(a) << 24));
+
+		for (; i + 4 <= n; i += 4)
+		{
+			__m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+			__m128i lo = _mm_unpacklo_epi8(p, zero);
+			__m128i hi = _mm_unpackhi_epi8(p, zero);
+			lo = div255_epu16(_mm_add_epi16(_mm_mullo_epi16(lo, ia), src));
+			hi = div255_epu16(_mm_add_epi16(_mm_mullo_epi16(hi, ia), src));
+			p = _mm_or_si128(_mm_and_si128(_mm_packus_epi16(lo, hi), rgb), amask);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), p);
+		}
+	}
+#endif
+
+	for (; i < n; i++)
+		dst[i] = blend(dst[i], r, g, b, a);
+}
+
+void grey_span(int32_t * dst, size_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+	size_t i = 0;
+
+	// Opaque greyscale fill is a solid fill with the grey color
+	if (a == 255)
+	{
+		fill_span(dst, n, grey(static_cast<int32_t>(0xFF000000 | (r << 16) | (g << 8) | b)));
+		return;
+	}
+
+	const short ra = static_cast<short>(r * a);
+	const short ga = static_cast<short>(g * a);
+	const short ba = static_cast<short>(b * a);
+
+#if defined(BLEND_AVX2)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i src = _mm256_set_epi16(0, ra, ga, ba, 0, ra, ga, ba, 0, ra, ga, ba, 0, ra, ga, ba);
+		const __m256i ia = _mm256_set1_epi16(static_cast<short>(255 - a));
+		const __m256i amask = _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(a) << 24));
+
+		for (; i + 8 <= n; i += 8)
+		{
+			__m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+			__m256i lo = _mm256_unpacklo_epi8(p, zero);
+			__m256i hi = _mm256_unpackhi_epi8(p, zero);
+			lo = div255_epu16(_mm256_add_epi16(_mm256_mullo_epi16(lo, ia), src));
+			hi = div255_epu16(_mm256_add_epi16(_mm256_mullo_epi16(hi, ia), src));
+			p = grey_epu32(_mm256_packus_epi16(lo, hi), amask);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), p);
+		}
+	}
+#endif
+#if defined(BLEND_SSE2)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i src = _mm_set_epi16(0, ra, ga, ba, 0, ra, ga, ba);
+		const __m128i ia = _mm_set1_epi16(static_cast<short>(255 - a));
+		const __m128i amask = _mm_set1_epi32(static_cast<int>(static_cast<uint32_t>(a) << 24));
+
+		for (; i + 4 <= n; i += 4)
+		{
+			__m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+			__m128i lo = _mm_unpacklo_epi8(p, zero);
+			__m128i hi = _mm_unpackhi_epi8(p, zero);
+			lo = div255_epu16(_mm_add_epi16(_mm_mullo_epi16(lo, ia), src));
+			hi = div255_epu16(_mm_add_epi16(_mm_mullo_epi16(hi, ia), src));
+			p = grey_epu32(_mm_packus_epi16(lo, hi), amask);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), p);
+		}
+	}
+#endif
+
+	for (; i < n; i++)
+		dst[i] = grey(blend(dst[i], r, g, b, a));
+}
+
+void blend_src_span(int32_t * dst, const int32_t * src, size_t n)
+{
+	size_t i = 0;
+
+#if defined(BLEND_SSE2)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i full = _mm_set1_epi16(255);
+		const __m128i rgb = _mm_set1_epi32(0x00FFFFFF);
+		const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+		for (; i + 4 <= n; i += 4)
+		{
+			__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+			__m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+
+			// Source alpha per pixel, broadcast to each component lane
+			__m128i s_lo = _mm_unpacklo_epi8(s, zero);
+			__m128i s_hi = _mm_unpackhi_epi8(s, zero);
+			__m128i a_lo = alpha_epu16(s_lo);
+			__m128i a_hi = alpha_epu16(s_hi);
+
+			// old * (255 - a) + new * a
+			__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(p, zero), _mm_sub_epi16(full, a_lo)), _mm_mullo_epi16(s_lo, a_lo));
+			__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(p, zero), _mm_sub_epi16(full, a_hi)), _mm_mullo_epi16(s_hi, a_hi));
+			lo = div255_epu16(lo);
+			hi = div255_epu16(hi);
+
+			p = _mm_or_si128(_mm_and_si128(_mm_packus_epi16(lo, hi), rgb), _mm_and_si128(s, alpha));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), p);
+		}
+	}
+#endif
+
+	for (; i < n; i++)
+	{
+		uint32_t s = static_cast<uint32_t>(src[i]);
+
+		dst[i] = blend(
+			dst[i],
+			static_cast<uint8_t>((s & 0x00FF0000) >> 16),
+			static_cast<uint8_t>((s & 0x0000FF00) >> 8),
+			static_cast<uint8_t>((s & 0x000000FF)),
+			static_cast<uint8_t>((s & 0xFF000000) >> 24)
+		);
+	}
+}
+
+void blend_src_const_span(int32_t * dst, const int32_t * src, size_t n, uint8_t a)
+{
+	size_t i = 0;
+
+	// Opaque copy does not need to read the destination
+	if (a == 255)
+	{
+		for (; i < n; i++)
+			dst[i] = static_cast<int32_t>(static_cast<uint32_t>(src[i]) | 0xFF000000);
+		return;
+	}
+
+#if defined(BLEND_SSE2)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i sa = _mm_set1_epi16(a);
+		const __m128i ia = _mm_set1_epi16(static_cast<short>(255 - a));
+		const __m128i rgb = _mm_set1_epi32(0x00FFFFFF);
+		const __m128i amask = _mm_set1_epi32(static_cast<int>(static_cast<uint32_t>(a) << 24));
+
+		for (; i + 4 <= n; i += 4)
+		{
+			__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+			__m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+
+			// old * (255 - a) + new * a
+			__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(p, zero), ia), _mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), sa));
+			__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(p, zero), ia), _mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), sa));
+			lo = div255_epu16(lo);
+			hi = div255_epu16(hi);
+
+			p = _mm_or_si128(_mm_and_si128(_mm_packus_epi16(lo, hi), rgb), amask);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), p);
+		}
+	}
+#endif
+
+	for (; i < n; i++)
+	{
+		uint32_t s = static_cast<uint32_t>(src[i]);
+
+		dst[i] = blend(
+			dst[i],
+			static_cast<uint8_t>((s & 0x00FF0000) >> 16),
+			static_cast<uint8_t>((s & 0x0000FF00) >> 8),
+			static_cast<uint8_t>((s & 0x000000FF)),
+			a
+		);
+	}
+}
+
+void blend_mask_span(int32_t * dst, const uint8_t * mask, size_t n, uint8_t r, uint8_t g, uint8_t b)
+{
+	size_t i = 0;
+
+#if defined(BLEND_SSE2)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i full = _mm_set1_epi16(255);
+		const __m128i col = _mm_set_epi16(0, r, g, b, 0, r, g, b);
+		const __m128i rgb = _mm_set1_epi32(0x00FFFFFF);
+
+		for (; i + 4 <= n; i += 4)
+		{
+			// Load four coverage values, skip fully transparent quads
+			uint32_t m4 = static_cast<uint32_t>(mask[i]) | (static_cast<uint32_t>(mask[i + 1]) << 8) | (static_cast<uint32_t>(mask[i + 2]) << 16) | (static_cast<uint32_t>(mask[i + 3]) << 24);
+			if (m4 == 0)
+				continue;
+
+			__m128i m16 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(m4)), zero);
+			__m128i m16x2 = _mm_unpacklo_epi16(m16, m16);
+			__m128i a_lo = _mm_unpacklo_epi32(m16x2, m16x2);
+			__m128i a_hi = _mm_unpackhi_epi32(m16x2, m16x2);
+
+			__m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+			__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(p, zero), _mm_sub_epi16(full, a_lo)), _mm_mullo_epi16(col, a_lo));
+			__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(p, zero), _mm_sub_epi16(full, a_hi)), _mm_mullo_epi16(col, a_hi));
+			lo = div255_epu16(lo);
+			hi = div255_epu16(hi);
+
+			// Coverage becomes the written alpha, uncovered pixels are left untouched
+			__m128i amask = _mm_slli_epi32(_mm_unpacklo_epi16(m16, zero), 24);
+			__m128i keep = _mm_cmpeq_epi32(amask, zero);
+			__m128i res = _mm_or_si128(_mm_and_si128(_mm_packus_epi16(lo, hi), rgb), amask);
+			p = _mm_or_si128(_mm_and_si128(keep, p), _mm_andnot_si128(keep, res));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), p);
+		}
+	}
+#endif
+
+	for (; i < n; i++)
+	{
+		if (mask[i] == 0)
+			continue;
+
+		dst[i] = blend(dst[i], r, g, b, mask[i]);
+	}
+}
+
+}
\ No newline at end of file
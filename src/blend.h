@@ -0,0 +1,80 @@
+#ifndef BLEND_H
+#define BLEND_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// ------------------------------------------------------------------------
+// -- SIMD PATH SELECTION
+// ------------------------------------------------------------------------
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLEND_SSE2 1
+#endif
+
+#if defined(__AVX2__)
+#define BLEND_AVX2 1
+#endif
+
+namespace Blend
+{
+
+// ------------------------------------------------------------------------
+// -- SCALAR HELPERS
+// ------------------------------------------------------------------------
+
+// Exact floor(x / 255) for x in range 0..255*255
+inline uint32_t div255(uint32_t x)
+{
+	return (x + 1 + (x >> 8)) >> 8;
+}
+
+// Mix old and new color component, a = 0..255 weight of the new color
+inline uint32_t mix(uint32_t c0, uint32_t c1, uint32_t a)
+{
+	return div255(c0 * (255 - a) + c1 * a);
+}
+
+// Blend a single ARGB pixel, result alpha is set to a (same as set_pixel)
+inline int32_t blend(int32_t dst, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+	uint32_t r_ = mix((dst & 0x00FF0000) >> 16, r, a);
+	uint32_t g_ = mix((dst & 0x0000FF00) >> 8, g, a);
+	uint32_t b_ = mix((dst & 0x000000FF), b, a);
+
+	return static_cast<int32_t>((static_cast<uint32_t>(a) << 24) | (r_ << 16) | (g_ << 8) | b_);
+}
+
+// Convert an ARGB pixel to greyscale using the max color component
+inline int32_t grey(int32_t argb)
+{
+	uint32_t c = std::max((argb & 0x00FF0000) >> 16, std::max((argb & 0x0000FF00) >> 8, (argb & 0x000000FF) >> 0));
+
+	return static_cast<int32_t>((static_cast<uint32_t>(argb) & 0xFF000000) | (c << 16) | (c << 8) | c);
+}
+
+// ------------------------------------------------------------------------
+// -- SPAN KERNELS
+// ------------------------------------------------------------------------
+
+// Solid fill, dst[0..n) = argb
+void fill_span(int32_t * dst, size_t n, int32_t argb);
+
+// Alpha fill with a constant color
+void blend_span(int32_t * dst, size_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+
+// Alpha fill with a constant color, result converted to greyscale
+void grey_span(int32_t * dst, size_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+
+// Alpha blend ARGB source pixels, alpha taken per pixel from the source
+void blend_src_span(int32_t * dst, const int32_t * src, size_t n);
+
+// Alpha blend ARGB source pixels with a constant alpha overriding the source alpha
+void blend_src_const_span(int32_t * dst, const int32_t * src, size_t n, uint8_t a);
+
+// Alpha fill with a constant color, alpha taken per pixel from a coverage mask
+void blend_mask_span(int32_t * dst, const uint8_t * mask, size_t n, uint8_t r, uint8_t g, uint8_t b);
+
+}
+
+#endif // BLEND_H
\ No newline at end of file
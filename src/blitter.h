@@ -0,0 +1,324 @@
+#ifndef BLITTER_H
+#define BLITTER_H
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include "blend.h"
+
+// ------------------------------------------------------------------------
+// -- COMPILE-TIME SPECIALISED BLITTERS
+// ------------------------------------------------------------------------
+// Every draw call picks one blend/camera/clip variant up front, the inner
+// row loops are then free of per-pixel branches.
+namespace Blitter
+{
+
+	enum Blend_t
+	{
+		B_OPAQUE = 0,
+		B_ALPHA = 1,
+		B_GREY = 2
+	};
+
+	// Render target, framebuffer + camera translation + clip rectangle
+	struct Target
+	{
+		int32_t * fb;
+		int pitch;					// fbo row length in pixels
+		bool camera;				// apply tx, ty translation
+		int tx, ty;					// camera + window center translation
+		int x0, y0, x1, y1;			// clip rectangle, [x0..x1) x [y0..y1)
+	};
+
+	enum SpanType_t : uint8_t
+	{
+		ST_TRANSPARENT = 0,
+		ST_OPAQUE = 1,
+		ST_TRANSLUCENT = 2
+	};
+
+	// Run of same-type pixels on a single image row
+	struct Span
+	{
+		uint16_t x;					// first pixel in row
+		uint16_t n;					// pixel count
+		SpanType_t type;			// how the run is blended
+	};
+
+	// Run-length encode an ARGB image into spans, rows holds the first span index per row (h + 1 entries)
+	inline void encode_spans(const int32_t * argb, int w, int h, std::vector<Span> & spans, std::vector<uint32_t> & rows)
+	{
+		spans.clear();
+		rows.resize(h + 1);
+
+		for (int i = 0; i < h; i++)
+		{
+			rows[i] = static_cast<uint32_t>(spans.size());
+
+			for (int j = 0; j < w; j++)
+			{
+				uint32_t a = (static_cast<uint32_t>(argb[j + i * w]) & 0xFF000000) >> 24;
+				SpanType_t type = (a == 0) ? ST_TRANSPARENT : (a == 255) ? ST_OPAQUE : ST_TRANSLUCENT;
+
+				// Extend the previous run on this row or start a new one
+				if (spans.size() > rows[i] && spans.back().type == type)
+				{
+					spans.back().n++;
+				}
+				else
+				{
+					Span span;
+					span.x = static_cast<uint16_t>(j);
+					span.n = 1;
+					span.type = type;
+					spans.push_back(span);
+				}
+			}
+		}
+
+		rows[h] = static_cast<uint32_t>(spans.size());
+	}
+
+	// Row fills, specialised per blend mode
+	template <Blend_t B> struct Fill;
+
+	template <> struct Fill<B_OPAQUE>
+	{
+		static inline void span(int32_t * dst, size_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t /*a*/)
+		{
+			Blend::fill_span(dst, n, static_cast<int32_t>(0xFF000000 | (r << 16) | (g << 8) | b));
+		}
+	};
+
+	template <> struct Fill<B_ALPHA>
+	{
+		static inline void span(int32_t * dst, size_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+		{
+			Blend::blend_span(dst, n, r, g, b, a);
+		}
+	};
+
+	template <> struct Fill<B_GREY>
+	{
+		static inline void span(int32_t * dst, size_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+		{
+			Blend::grey_span(dst, n, r, g, b, a);
+		}
+	};
+
+	// Row copies of ARGB source data, specialised per blend mode
+	template <Blend_t B> struct Copy;
+
+	template <> struct Copy<B_OPAQUE>
+	{
+		static inline void span(int32_t * dst, const int32_t * src, size_t n)
+		{
+			std::memcpy(dst, src, n * sizeof(int32_t));
+		}
+	};
+
+	template <> struct Copy<B_ALPHA>
+	{
+		static inline void span(int32_t * dst, const int32_t * src, size_t n)
+		{
+			Blend::blend_src_span(dst, src, n);
+		}
+	};
+
+	// Translate a rectangle, clip it if CLIP. Returns false if nothing is visible.
+	template <bool CAMERA, bool CLIP>
+	inline bool place(const Target & t, int & x, int & y, int & w, int & h, int & x_off, int & y_off)
+	{
+		if (CAMERA)
+		{
+			x += t.tx;
+			y += t.ty;
+		}
+
+		x_off = 0;
+		y_off = 0;
+
+		if (CLIP)
+		{
+			x_off = std::max(t.x0 - x, 0);
+			y_off = std::max(t.y0 - y, 0);
+			x += x_off;
+			y += y_off;
+			w = std::min(w - x_off, t.x1 - x);
+			h = std::min(h - y_off, t.y1 - y);
+
+			return (w > 0 && h > 0);
+		}
+
+		return true;
+	}
+
+	// Is the (untranslated) rectangle fully inside the clip rectangle
+	inline bool inside(const Target & t, int x, int y, int w, int h)
+	{
+		if (t.camera)
+		{
+			x += t.tx;
+			y += t.ty;
+		}
+
+		return (x >= t.x0 && y >= t.y0 && x + w <= t.x1 && y + h <= t.y1);
+	}
+
+	// ------------------------------------------------------------------------
+	// -- SPECIALISED VARIANTS
+	// ------------------------------------------------------------------------
+	template <Blend_t B, bool CAMERA, bool CLIP>
+	void rect(const Target & t, int x, int y, int w, int h, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+	{
+		int x_off, y_off;
+		if (place<CAMERA, CLIP>(t, x, y, w, h, x_off, y_off) == false)
+			return;
+
+		int32_t * row = t.fb + x + y * t.pitch;
+		for (int i = 0; i < h; i++, row += t.pitch)
+			Fill<B>::span(row, static_cast<size_t>(w), r, g, b, a);
+	}
+
+	template <Blend_t B, bool CAMERA, bool CLIP>
+	void image(const Target & t, int x, int y, int w, int h, const int32_t * argb)
+	{
+		int pitch = w, x_off, y_off;
+		if (place<CAMERA, CLIP>(t, x, y, w, h, x_off, y_off) == false)
+			return;
+
+		int32_t * row = t.fb + x + y * t.pitch;
+		const int32_t * src = argb + x_off + y_off * pitch;
+		for (int i = 0; i < h; i++, row += t.pitch, src += pitch)
+			Copy<B>::span(row, src, static_cast<size_t>(w));
+	}
+
+	template <bool CAMERA, bool CLIP>
+	void mask(const Target & t, int x, int y, int w, int h, const uint8_t * mask, uint8_t r, uint8_t g, uint8_t b)
+	{
+		int pitch = w, x_off, y_off;
+		if (place<CAMERA, CLIP>(t, x, y, w, h, x_off, y_off) == false)
+			return;
+
+		int32_t * row = t.fb + x + y * t.pitch;
+		const uint8_t * src = mask + x_off + y_off * pitch;
+		for (int i = 0; i < h; i++, row += t.pitch, src += pitch)
+			Blend::blend_mask_span(row, src, static_cast<size_t>(w), r, g, b);
+	}
+
+	template <bool CAMERA, bool CLIP>
+	void spans(const Target & t, int x, int y, int w, int h, const int32_t * argb, const Span * spans, const uint32_t * rows, int alpha)
+	{
+		int pitch = w, x_off, y_off;
+		if (place<CAMERA, CLIP>(t, x, y, w, h, x_off, y_off) == false)
+			return;
+
+		// Visible image columns, fbo pointer to image column 0 of the first visible row
+		const int c0 = x_off;
+		const int c1 = x_off + w;
+		int32_t * row = t.fb + (x - x_off) + y * t.pitch;
+
+		for (int i = y_off; i < y_off + h; i++, row += t.pitch)
+		{
+			for (uint32_t k = rows[i]; k < rows[i + 1]; k++)
+			{
+				const Span & span = spans[k];
+
+				if (span.type == ST_TRANSPARENT)
+					continue;
+
+				// Clip the span horizontally
+				int s0 = span.x;
+				int s1 = span.x + span.n;
+				if (CLIP)
+				{
+					s0 = std::max(s0, c0);
+					s1 = std::min(s1, c1);
+
+					if (s0 >= s1)
+						continue;
+				}
+
+				int32_t * dst = row + s0;
+				const int32_t * src = argb + s0 + i * pitch;
+				size_t n = static_cast<size_t>(s1 - s0);
+
+				// Forced alpha, opaque copy or per-pixel blend
+				if (alpha >= 0)
+					Blend::blend_src_const_span(dst, src, n, static_cast<uint8_t>(alpha));
+				else if (span.type == ST_OPAQUE)
+					Copy<B_OPAQUE>::span(dst, src, n);
+				else
+					Copy<B_ALPHA>::span(dst, src, n);
+			}
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	// -- DISPATCH, ONCE PER DRAW CALL
+	// ------------------------------------------------------------------------
+	template <Blend_t B>
+	inline void draw_rect_(const Target & t, int x, int y, int w, int h, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+	{
+		bool clip = (inside(t, x, y, w, h) == false);
+
+		if (t.camera)
+			(clip) ? rect<B, true, true>(t, x, y, w, h, r, g, b, a) : rect<B, true, false>(t, x, y, w, h, r, g, b, a);
+		else
+			(clip) ? rect<B, false, true>(t, x, y, w, h, r, g, b, a) : rect<B, false, false>(t, x, y, w, h, r, g, b, a);
+	}
+
+	inline void draw_rect(const Target & t, int x, int y, int w, int h, uint8_t r, uint8_t g, uint8_t b, uint8_t a, bool grey)
+	{
+		if (grey)
+			draw_rect_<B_GREY>(t, x, y, w, h, r, g, b, a);
+		else if (a == 255)
+			draw_rect_<B_OPAQUE>(t, x, y, w, h, r, g, b, a);
+		else
+			draw_rect_<B_ALPHA>(t, x, y, w, h, r, g, b, a);
+	}
+
+	template <Blend_t B>
+	inline void draw_image_(const Target & t, int x, int y, int w, int h, const int32_t * argb)
+	{
+		bool clip = (inside(t, x, y, w, h) == false);
+
+		if (t.camera)
+			(clip) ? image<B, true, true>(t, x, y, w, h, argb) : image<B, true, false>(t, x, y, w, h, argb);
+		else
+			(clip) ? image<B, false, true>(t, x, y, w, h, argb) : image<B, false, false>(t, x, y, w, h, argb);
+	}
+
+	inline void draw_image(const Target & t, int x, int y, int w, int h, const int32_t * argb, bool opaque)
+	{
+		if (opaque)
+			draw_image_<B_OPAQUE>(t, x, y, w, h, argb);
+		else
+			draw_image_<B_ALPHA>(t, x, y, w, h, argb);
+	}
+
+	inline void draw_mask(const Target & t, int x, int y, int w, int h, const uint8_t * m, uint8_t r, uint8_t g, uint8_t b)
+	{
+		bool clip = (inside(t, x, y, w, h) == false);
+
+		if (t.camera)
+			(clip) ? mask<true, true>(t, x, y, w, h, m, r, g, b) : mask<true, false>(t, x, y, w, h, m, r, g, b);
+		else
+			(clip) ? mask<false, true>(t, x, y, w, h, m, r, g, b) : mask<false, false>(t, x, y, w, h, m, r, g, b);
+	}
+
+	inline void draw_spans(const Target & t, int x, int y, int w, int h, const int32_t * argb, const Span * s, const uint32_t * rows, int alpha)
+	{
+		bool clip = (inside(t, x, y, w, h) == false);
+
+		if (t.camera)
+			(clip) ? spans<true, true>(t, x, y, w, h, argb, s, rows, alpha) : spans<true, false>(t, x, y, w, h, argb, s, rows, alpha);
+		else
+			(clip) ? spans<false, true>(t, x, y, w, h, argb, s, rows, alpha) : spans<false, false>(t, x, y, w, h, argb, s, rows, alpha);
+	}
+
+}
+
+#endif // BLITTER_H
\ No newline at end of file
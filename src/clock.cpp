@@ -0,0 +1,43 @@
+#include "clock.h"
+#include <SDL2/SDL.h>
+
+namespace Clock
+{
+
+	// Counter value at the first query, keeps seconds() small + precise
+	static uint64_t start()
+	{
+		static const uint64_t START = SDL_GetPerformanceCounter();
+		return START;
+	}
+
+	uint64_t ticks()
+	{
+		return SDL_GetPerformanceCounter();
+	}
+
+	uint64_t frequency()
+	{
+		static const uint64_t FREQUENCY = SDL_GetPerformanceFrequency();
+		return FREQUENCY;
+	}
+
+	double seconds()
+	{
+		uint64_t t0 = start();
+		return to_seconds(ticks() - t0);
+	}
+
+	double to_seconds(uint64_t ticks)
+	{
+		// Split whole + fractional seconds so large counts keep their precision
+		uint64_t freq = frequency();
+		return static_cast<double>(ticks / freq) + static_cast<double>(ticks % freq) / static_cast<double>(freq);
+	}
+
+	uint64_t to_ticks(double seconds)
+	{
+		return static_cast<uint64_t>(seconds * static_cast<double>(frequency()));
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <cstdint>
+
+// High-resolution monotonic clock on top of the platform performance counter
+namespace Clock
+{
+
+	// Raw counter ticks + ticks per second
+	uint64_t ticks();
+	uint64_t frequency();
+
+	// Seconds since the first clock query, double precision
+	double seconds();
+
+	// Tick <-> second conversion
+	double to_seconds(uint64_t ticks);
+	uint64_t to_ticks(double seconds);
+
+}
+
+#endif // CLOCK_H
\ No newline at end of file
@@ -2,8 +2,15 @@
 #include <SDL2/SDL.h>
 #include "3rdparty/mlibc_log.h"
 #include "texture_manager.h"
+#include "sprite.h"
+#include "blend.h"
+#include "blitter.h"
+#include "job_manager.h"
 #include "math.h"
 
+// Screen tile edge in pixels, draw calls are binned + rasterised per tile
+#define TILE_SIZE 64
+
 namespace DisplayManager
 {
 
@@ -12,6 +19,114 @@ namespace DisplayManager
 	std::map<std::string, Window *> LOADED_WINDOWS = std::map<std::string, Window *>();
 	std::map<std::string, Camera *> LOADED_CAMERAS = std::map<std::string, Camera *>();
 
+	// Camera used by draw calls instead of ACTIVE_CAMERA while OVERRIDE_ENABLED
+	static bool OVERRIDE_ENABLED = false;
+	static const Camera * OVERRIDE_CAMERA = nullptr;
+
+	enum DrawCmd_t : uint8_t
+	{
+		DC_FILL = 0,
+		DC_RECT = 1,
+		DC_IMAGE = 2,
+		DC_SPANS = 3,
+		DC_MASK = 4
+	};
+
+	// Recorded draw call, rasterised per screen tile on flush()
+	struct DrawCmd
+	{
+		DrawCmd_t type;
+		bool camera;						// camera translation captured at record time
+		int tx, ty;
+		int x, y, w, h;						// untranslated rectangle
+		int x0, y0, x1, y1;					// on-screen bounds, clipped to the fbo
+		int32_t argb;						// DC_FILL color
+		uint8_t r, g, b, a;					// DC_RECT/DC_MASK color
+		bool flag;							// DC_RECT grey, DC_IMAGE opaque
+		int alpha;							// DC_SPANS forced alpha
+		const int32_t * pixels;				// DC_IMAGE/DC_SPANS source
+		const uint8_t * mask;				// DC_MASK source
+		const Blitter::Span * spans;		// DC_SPANS runs
+		const uint32_t * rows;				// DC_SPANS row index
+	};
+
+	static std::vector<DrawCmd> DRAW_CMDS;
+	static std::vector<std::vector<uint32_t>> DRAW_BINS;
+
+	// Build a blitter target for the active window + camera, clipped to the whole fbo
+	static Blitter::Target active_target()
+	{
+		Blitter::Target t;
+		const Camera * camera = (OVERRIDE_ENABLED) ? OVERRIDE_CAMERA : ACTIVE_CAMERA;
+
+		t.fb = ACTIVE_WINDOW->framebuffer;
+		t.pitch = ACTIVE_WINDOW->width;
+		t.camera = (camera != nullptr);
+		t.tx = (t.camera) ? ACTIVE_WINDOW->width / 2 - camera->x : 0;
+		t.ty = (t.camera) ? ACTIVE_WINDOW->height / 2 + camera->y : 0;
+		t.x0 = 0;
+		t.y0 = 0;
+		t.x1 = ACTIVE_WINDOW->width;
+		t.y1 = ACTIVE_WINDOW->height;
+
+		return t;
+	}
+
+	// Start a draw call with the active camera translation + on-screen bounds
+	static DrawCmd make_cmd(DrawCmd_t type, int x, int y, int w, int h)
+	{
+		Blitter::Target t = active_target();
+		DrawCmd cmd = DrawCmd();
+
+		cmd.type = type;
+		cmd.camera = t.camera;
+		cmd.tx = t.tx;
+		cmd.ty = t.ty;
+		cmd.x = x;
+		cmd.y = y;
+		cmd.w = w;
+		cmd.h = h;
+		cmd.x0 = std::max(x + t.tx * t.camera, t.x0);
+		cmd.y0 = std::max(y + t.ty * t.camera, t.y0);
+		cmd.x1 = std::min(x + t.tx * t.camera + w, t.x1);
+		cmd.y1 = std::min(y + t.ty * t.camera + h, t.y1);
+
+		return cmd;
+	}
+
+	// Queue a draw call, calls with nothing visible are dropped
+	static void record(const DrawCmd & cmd)
+	{
+		if (cmd.x0 < cmd.x1 && cmd.y0 < cmd.y1)
+		{
+			DRAW_CMDS.push_back(cmd);
+		}
+	}
+
+	// Rasterise a single draw call, clipped to the target (tile)
+	static void execute(const DrawCmd & cmd, Blitter::Target t)
+	{
+		t.camera = cmd.camera;
+		t.tx = cmd.tx;
+		t.ty = cmd.ty;
+
+		switch (cmd.type)
+		{
+			case DC_FILL:
+			{
+				int x0 = std::max(cmd.x0, t.x0);
+				int x1 = std::min(cmd.x1, t.x1);
+				int y1 = std::min(cmd.y1, t.y1);
+				for (int i = std::max(cmd.y0, t.y0); i < y1 && x0 < x1; i++)
+					Blend::fill_span(t.fb + x0 + i * t.pitch, static_cast<size_t>(x1 - x0), cmd.argb);
+			} break;
+			case DC_RECT: Blitter::draw_rect(t, cmd.x, cmd.y, cmd.w, cmd.h, cmd.r, cmd.g, cmd.b, cmd.a, cmd.flag); break;
+			case DC_IMAGE: Blitter::draw_image(t, cmd.x, cmd.y, cmd.w, cmd.h, cmd.pixels, cmd.flag); break;
+			case DC_SPANS: Blitter::draw_spans(t, cmd.x, cmd.y, cmd.w, cmd.h, cmd.pixels, cmd.spans, cmd.rows, cmd.alpha); break;
+			case DC_MASK: Blitter::draw_mask(t, cmd.x, cmd.y, cmd.w, cmd.h, cmd.mask, cmd.r, cmd.g, cmd.b); break;
+		}
+	}
+
 	// Init
 	void init()
 	{
@@ -44,7 +159,8 @@ namespace DisplayManager
 		int width,
 		int height,
 		int scale,
-		bool fullscreen
+		bool fullscreen,
+		bool vsync
 	)
 	{
 		if (LOADED_WINDOWS.count(title) == 0)
@@ -75,7 +191,7 @@ namespace DisplayManager
 			window->renderer = SDL_CreateRenderer(
 				window->handle,
 				-1,
-				SDL_RENDERER_ACCELERATED
+				SDL_RENDERER_ACCELERATED | ((vsync) ? SDL_RENDERER_PRESENTVSYNC : 0)
 			);
 
 			if (window->renderer == NULL)
@@ -126,6 +242,9 @@ namespace DisplayManager
 	{
 		if (LOADED_WINDOWS.count(title) > 0)
 		{
+			// Pending draw calls belong to the previous window
+			flush();
+
 			ACTIVE_WINDOW = LOADED_WINDOWS[title];
 		}
 		else
@@ -170,10 +289,65 @@ namespace DisplayManager
 		}
 	}
 
+	void override_camera(bool enabled, const Camera * camera)
+	{
+		OVERRIDE_ENABLED = enabled;
+		OVERRIDE_CAMERA = camera;
+	}
+
+	void flush()
+	{
+		if (ACTIVE_WINDOW == nullptr || DRAW_CMDS.empty())
+		{
+			DRAW_CMDS.clear();
+			return;
+		}
+
+		// Bin draw calls into the screen tiles they touch, preserving call order per tile
+		int tiles_x = (ACTIVE_WINDOW->width + TILE_SIZE - 1) / TILE_SIZE;
+		int tiles_y = (ACTIVE_WINDOW->height + TILE_SIZE - 1) / TILE_SIZE;
+		DRAW_BINS.resize(tiles_x * tiles_y);
+		for (auto & bin : DRAW_BINS)
+			bin.clear();
+
+		for (size_t k = 0; k < DRAW_CMDS.size(); k++)
+		{
+			const DrawCmd & cmd = DRAW_CMDS[k];
+
+			for (int ty = cmd.y0 / TILE_SIZE; ty <= (cmd.y1 - 1) / TILE_SIZE; ty++)
+			{
+				for (int tx = cmd.x0 / TILE_SIZE; tx <= (cmd.x1 - 1) / TILE_SIZE; tx++)
+				{
+					DRAW_BINS[tx + ty * tiles_x].push_back(static_cast<uint32_t>(k));
+				}
+			}
+		}
+
+		// Rasterise tiles in parallel, each tile only writes its own pixels
+		Blitter::Target target = active_target();
+		JobManager::parallel_for(DRAW_BINS.size(), [&](size_t tile) {
+			Blitter::Target t = target;
+			t.x0 = static_cast<int>(tile % tiles_x) * TILE_SIZE;
+			t.y0 = static_cast<int>(tile / tiles_x) * TILE_SIZE;
+			t.x1 = std::min(t.x0 + TILE_SIZE, ACTIVE_WINDOW->width);
+			t.y1 = std::min(t.y0 + TILE_SIZE, ACTIVE_WINDOW->height);
+
+			for (uint32_t k : DRAW_BINS[tile])
+			{
+				execute(DRAW_CMDS[k], t);
+			}
+		});
+
+		DRAW_CMDS.clear();
+	}
+
 	void render()
 	{
 		if (ACTIVE_WINDOW != nullptr)
 		{
+			// Rasterise pending draw calls
+			flush();
+
 			SDL_UpdateTexture(
 				ACTIVE_WINDOW->texture,
 				NULL,
@@ -194,10 +368,15 @@ namespace DisplayManager
 	{
 		if (ACTIVE_WINDOW != nullptr)
 		{
-			size_t resolution = static_cast<size_t>(ACTIVE_WINDOW->width * ACTIVE_WINDOW->height);
-
-			for (size_t i = 0; i < resolution; i++)
-				ACTIVE_WINDOW->framebuffer[i] = argb;
+			// Whole-fbo fill, ignores the camera
+			DrawCmd cmd = make_cmd(DC_FILL, 0, 0, ACTIVE_WINDOW->width, ACTIVE_WINDOW->height);
+			cmd.camera = false;
+			cmd.x0 = 0;
+			cmd.y0 = 0;
+			cmd.x1 = ACTIVE_WINDOW->width;
+			cmd.y1 = ACTIVE_WINDOW->height;
+			cmd.argb = argb;
+			record(cmd);
 		}
 		else
 		{
@@ -217,53 +396,8 @@ namespace DisplayManager
 	{
 		if (ACTIVE_WINDOW != nullptr)
 		{
-			// Calculate camera translation
-			if (ACTIVE_CAMERA != nullptr)
-			{
-				// Camera translation
-				x -= ACTIVE_CAMERA->x;
-				y += ACTIVE_CAMERA->y;
-
-				// Window offset
-				x += ACTIVE_WINDOW->width / 2;
-				y += ACTIVE_WINDOW->height / 2;
-			}
-
-			// Prevent altering memory outside fbo
-			if (x < 0 || x >= ACTIVE_WINDOW->width || y < 0 || y >= ACTIVE_WINDOW->height)
-				return;
-
-			// Alpha, mix between old and new color
-			if (a < 255)
-			{
-				// Get old ARGB value + decode to RGB components
-				auto argb_ = ACTIVE_WINDOW->framebuffer[x + y * ACTIVE_WINDOW->width];
-				auto r_ = (argb_ & 0x00FF0000) >> 16;
-				auto g_ = (argb_ & 0x0000FF00) >> 8;
-				auto b_ = (argb_ & 0x000000FF);
-
-				// Linearly interpolate between old and new RGB components based on input alpha
-				r = Math::lerp(r_, r, a);
-				g = Math::lerp(g_, g, a);
-				b = Math::lerp(b_, b, a);
-			}
-
-			// Greyscale rendering
-			if (grey)
-			{
-				// Get max color component value
-				uint8_t c = std::max(r, std::max(g, b));
-
-				// Set all components to same value
-				r = c;
-				g = c;
-				b = c;
-			}
-
-			// Encode new ARGB component values back hex
-			auto argb = ((a << 24) | (r << 16) | (g << 8) | b);
-
-			ACTIVE_WINDOW->framebuffer[x + y * ACTIVE_WINDOW->width] = argb;
+			// Single pixel rectangle, translated + clipped by the blitter
+			set_rect(x, y, 1, 1, r, g, b, a, grey);
 		}
 		else
 		{
@@ -285,18 +419,14 @@ namespace DisplayManager
 	{
 		if (ACTIVE_WINDOW != nullptr)
 		{
-			// Translate width and height by x and y
-			w += x;
-			h += y;
-
-			// Render the rectangle
-			for (int i = y; i < h; i++)
-			{
-				for (int j = x; j < w; j++)
-				{
-					set_pixel(j, i, r, g, b, a, grey);
-				}
-			}
+			// Blend variant is selected once for the whole rectangle
+			DrawCmd cmd = make_cmd(DC_RECT, x, y, w, h);
+			cmd.r = r;
+			cmd.g = g;
+			cmd.b = b;
+			cmd.a = a;
+			cmd.flag = grey;
+			record(cmd);
 		}
 		else
 		{
@@ -304,6 +434,79 @@ namespace DisplayManager
 		}
 	}
 
+	void set_image(
+		int x,
+		int y,
+		int w,
+		int h,
+		const int32_t * argb,
+		bool opaque
+	)
+	{
+		if (ACTIVE_WINDOW != nullptr)
+		{
+			// Blend variant is selected once for the whole image
+			DrawCmd cmd = make_cmd(DC_IMAGE, x, y, w, h);
+			cmd.pixels = argb;
+			cmd.flag = opaque;
+			record(cmd);
+		}
+		else
+		{
+			mlibc_err("DisplayManager::set_image(). Error, ACTIVE_WINDOW is pointing to NULL!");
+		}
+	}
+
+	void set_sprite(
+		int x,
+		int y,
+		const SpriteFrame * frame,
+		int alpha
+	)
+	{
+		if (ACTIVE_WINDOW != nullptr)
+		{
+			// Clipped once per sprite (+ tile), then blitted span by span
+			DrawCmd cmd = make_cmd(DC_SPANS, x, y, frame->w, frame->h);
+			cmd.pixels = frame->pixels.data();
+			cmd.spans = frame->spans.data();
+			cmd.rows = frame->rows.data();
+			cmd.alpha = alpha;
+			record(cmd);
+		}
+		else
+		{
+			mlibc_err("DisplayManager::set_sprite(). Error, ACTIVE_WINDOW is pointing to NULL!");
+		}
+	}
+
+	void set_mask(
+		int x,
+		int y,
+		int w,
+		int h,
+		const uint8_t * mask,
+		uint8_t r,
+		uint8_t g,
+		uint8_t b
+	)
+	{
+		if (ACTIVE_WINDOW != nullptr)
+		{
+			// Camera/clip variant is selected once for the whole mask
+			DrawCmd cmd = make_cmd(DC_MASK, x, y, w, h);
+			cmd.mask = mask;
+			cmd.r = r;
+			cmd.g = g;
+			cmd.b = b;
+			record(cmd);
+		}
+		else
+		{
+			mlibc_err("DisplayManager::set_mask(). Error, ACTIVE_WINDOW is pointing to NULL!");
+		}
+	}
+
 	void set_text(
 		int x,
 		int y,
@@ -318,43 +521,16 @@ namespace DisplayManager
 	{
 		if (ACTIVE_WINDOW != nullptr)
 		{
-			// Render each character
+			// Pre-scaled glyph masks for this font + size, one lookup per call
+			TextureManager::GlyphSet * glyphs = TextureManager::load_glyphs(font, c_width, c_height);
+
+			// Render each character as a masked fill
 			int c_idx = 0;
 			for (char & c : text)
 			{
-				// Get char texture index
-				TextureManager::CharIdx char_idx = font->char_map[c];
-
-				// Skip rendering if it's a space
-				if (isspace(char_idx.key))
-				{
-					c_idx++;
-					continue;
-				}
-
-				// Calculate font size <-> char size ratio
-				float char_rat_w = static_cast<float>(font->char_width) / static_cast<float>(c_width);
-				float char_rat_h = static_cast<float>(font->char_height) / static_cast<float>(c_height);
-
-				for (int i = 0; i < c_width; i++)
+				if (glyphs->visible[static_cast<unsigned char>(c)])
 				{
-					for (int j = 0; j < c_height; j++)
-					{
-						// Calculate texcoords and sample the pixel + scale according to size diff
-						int char_tex_x = char_idx.x * font->char_width + static_cast<int>(j * char_rat_w);
-						int char_tex_y = char_idx.y * font->char_height + static_cast<int>(i * char_rat_h);
-						auto char_argb = TextureManager::sample_texture(font->texture->file_path, char_tex_x, char_tex_y);
-
-						// Decode char ARGB hex value into component(s)
-						auto char_a = (char_argb & 0xFF000000) >> 24;
-
-						// Calculate on-screen fbo metrics
-						int char_x = x + j + (c_width * c_idx);
-						int char_y = y + i;
-
-						// Set pixel
-						set_pixel(char_x, char_y, r, g, b, char_a, false);
-					}
+					set_mask(x + (c_width * c_idx), y, c_width, c_height, glyphs->mask(c), r, g, b);
 				}
 
 				// increase char idx
@@ -4,11 +4,14 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <cstdint>
 
 typedef struct SDL_Window SDL_Window;
 typedef struct SDL_Renderer SDL_Renderer;
 typedef struct SDL_Texture SDL_Texture;
 
+struct SpriteFrame;
+
 namespace TextureManager
 {
 	struct Font;
@@ -52,7 +55,8 @@ namespace DisplayManager
 		int width = 640,
 		int height = 467,
 		int scale = 1,
-		bool fullscreen = false
+		bool fullscreen = false,
+		bool vsync = false
 	);
 	void activate_window(const std::string & title);
 
@@ -65,6 +69,13 @@ namespace DisplayManager
 	);
 	void activate_camera(const std::string & identifier);
 
+	// Draw calls use camera (nullptr = none) instead of ACTIVE_CAMERA while enabled,
+	// so a render thread can replay recorded cameras without touching ACTIVE_CAMERA.
+	void override_camera(bool enabled, const Camera * camera = nullptr);
+
+	// Draw calls below are recorded and rasterised in parallel screen tiles
+	// on flush() / render(), source data must stay valid until then.
+	void flush();
 	void render();
 	void clear(const int32_t argb);
 	void set_pixel(
@@ -87,6 +98,30 @@ namespace DisplayManager
 		uint8_t a = 255,
 		bool grey = false
 	);
+	void set_image(
+		int x,
+		int y,
+		int w,
+		int h,
+		const int32_t * argb,
+		bool opaque = false
+	);
+	void set_sprite(
+		int x,
+		int y,
+		const SpriteFrame * frame,
+		int alpha = -1
+	);
+	void set_mask(
+		int x,
+		int y,
+		int w,
+		int h,
+		const uint8_t * mask,
+		uint8_t r,
+		uint8_t g,
+		uint8_t b
+	);
 	void set_text(
 		int x,
 		int y,
@@ -0,0 +1,43 @@
+#ifndef ENTITY_HANDLE_H
+#define ENTITY_HANDLE_H
+
+#include <cstdint>
+
+// Reference to an entity, stays valid across destroy() of other entities and
+// resolves to nothing once its own entity is destroyed (generation mismatch)
+struct EntityHandle
+{
+	uint32_t index;										// slot index
+	uint32_t gen;										// slot generation, 0 = null handle
+
+	EntityHandle() :
+		index(0),
+		gen(0)
+	{
+
+	}
+
+	EntityHandle(uint32_t index, uint32_t gen) :
+		index(index),
+		gen(gen)
+	{
+
+	}
+
+	bool operator==(const EntityHandle & other) const
+	{
+		return index == other.index && gen == other.gen;
+	}
+
+	bool operator!=(const EntityHandle & other) const
+	{
+		return !(*this == other);
+	}
+
+	bool isNull() const
+	{
+		return gen == 0;
+	}
+};
+
+#endif // ENTITY_HANDLE_H
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "frame_graph.h"
+#include <thread>
+#include "clock.h"
+#include "job_manager.h"
+#include "3rdparty/mlibc_log.h"
+
+FrameGraph::FrameGraph() :
+	m_nodes(),
+	m_remaining(),
+	m_done(0),
+	m_mainMutex(),
+	m_mainReady(),
+	m_t0(0.0),
+	m_time(0.0)
+{
+
+}
+
+FrameGraph::~FrameGraph()
+{
+
+}
+
+size_t FrameGraph::add(const std::string & name, uint32_t reads, uint32_t writes, std::function<void()> fn, uint8_t flags)
+{
+	FrameNode node;
+	node.name = name;
+	node.reads = reads;
+	node.writes = writes;
+	node.flags = flags;
+	node.enabled = true;
+	node.fn = fn;
+	node.start = 0.0;
+	node.time = 0.0;
+	node.avg = 0.0;
+	node.runs = 0;
+
+	// Depend on every earlier node touching the same data, unless both only read it
+	size_t id = m_nodes.size();
+	for (size_t i = 0; i < id; i++)
+	{
+		FrameNode & other = m_nodes[i];
+		if ((other.writes & (reads | writes)) || (other.reads & writes))
+		{
+			node.deps.push_back(i);
+			other.dependents.push_back(id);
+		}
+	}
+
+	m_nodes.push_back(node);
+	m_remaining.reset(new std::atomic<int>[m_nodes.size()]);
+
+	return id;
+}
+
+void FrameGraph::setEnabled(size_t id, bool enabled)
+{
+	m_nodes[id].enabled = enabled;
+}
+
+void FrameGraph::run()
+{
+	size_t n = m_nodes.size();
+	if (n == 0)
+		return;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		m_remaining[i] = static_cast<int>(m_nodes[i].deps.size());
+	}
+	m_done = 0;
+	m_t0 = Clock::seconds();
+
+	for (size_t i = 0; i < n; i++)
+	{
+		if (m_nodes[i].deps.empty())
+			launch(i);
+	}
+
+	// Run main thread stages as they become ready, help with the jobs otherwise
+	while (m_done < n)
+	{
+		size_t id = n;
+		{
+			std::lock_guard<std::mutex> lock(m_mainMutex);
+			if (m_mainReady.empty() == false)
+			{
+				id = m_mainReady.back();
+				m_mainReady.pop_back();
+			}
+		}
+
+		if (id < n)
+			execute(id);
+		else if (JobManager::help() == false)
+			std::this_thread::yield();
+	}
+
+	m_time = Clock::seconds() - m_t0;
+}
+
+void FrameGraph::dump() const
+{
+	mlibc_inf("FrameGraph::dump(). %zu stage(s), last run %.3f ms.", m_nodes.size(), m_time * 1000.0);
+
+	for (auto & node : m_nodes)
+	{
+		std::string deps;
+		for (auto d : node.deps)
+		{
+			deps += (deps.empty() ? "" : ", ") + m_nodes[d].name;
+		}
+
+		mlibc_inf("FrameGraph::dump(). %-16s %s start %7.3f ms, took %7.3f ms, avg %7.3f ms, runs %llu, after: %s",
+			node.name.c_str(),
+			(node.flags & FN_MAIN) ? "main" : "job ",
+			node.start * 1000.0,
+			node.time * 1000.0,
+			node.avg * 1000.0,
+			static_cast<unsigned long long>(node.runs),
+			deps.empty() ? "-" : deps.c_str()
+		);
+	}
+}
+
+const std::vector<FrameNode> & FrameGraph::getNodes() const
+{
+	return m_nodes;
+}
+
+double FrameGraph::getTime() const
+{
+	return m_time;
+}
+
+void FrameGraph::launch(size_t id)
+{
+	FrameNode & node = m_nodes[id];
+
+	if (node.enabled == false)
+	{
+		node.start = Clock::seconds() - m_t0;
+		node.time = 0.0;
+		finish(id);
+	}
+	else if (node.flags & FN_MAIN)
+	{
+		std::lock_guard<std::mutex> lock(m_mainMutex);
+		m_mainReady.push_back(id);
+	}
+	else
+	{
+		JobManager::run([this, id]() { execute(id); });
+	}
+}
+
+void FrameGraph::execute(size_t id)
+{
+	FrameNode & node = m_nodes[id];
+
+	double t0 = Clock::seconds();
+	node.fn();
+	double t1 = Clock::seconds();
+
+	node.start = t0 - m_t0;
+	node.time = t1 - t0;
+	node.avg = (node.runs == 0) ? node.time : node.avg * 0.95 + node.time * 0.05;
+	node.runs++;
+
+	finish(id);
+}
+
+void FrameGraph::finish(size_t id)
+{
+	// Release the dependents before counting this node as done, run() keeps waiting for them
+	for (auto d : m_nodes[id].dependents)
+	{
+		if (m_remaining[d].fetch_sub(1) == 1)
+			launch(d);
+	}
+
+	m_done++;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#ifndef FRAME_GRAPH_H
+#define FRAME_GRAPH_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+// Data a stage reads or writes, one bit each
+enum FrameResource_t : uint32_t
+{
+	FR_NONE = 0,
+	FR_INPUT = 1 << 0,						// input events + key state
+	FR_CONTROL = 1 << 1,					// resolved controller actions
+	FR_ENTITIES = 1 << 2,					// entity components
+	FR_PROJECTILES = 1 << 3,
+	FR_EDITS = 1 << 4,						// deferred terrain edits
+	FR_TERRAIN = 1 << 5,					// level bitmap
+	FR_AUDIO = 1 << 6,
+	FR_STATE = 1 << 7,						// game state as a whole
+	FR_FRAME = 1 << 8,						// recorded render frame
+	FR_SCREEN = 1 << 9,						// window framebuffer
+	FR_ALL = 0xFFFFFFFF
+};
+
+enum FrameNodeFlags_t : uint8_t
+{
+	FN_NONE = 0,
+	FN_MAIN = 1 << 0						// runs on the thread calling run() (SDL calls, audio)
+};
+
+struct FrameNode
+{
+	std::string name;
+	uint32_t reads;							// FrameResource_t bits
+	uint32_t writes;						// FrameResource_t bits
+	uint8_t flags;							// FrameNodeFlags_t bits
+	bool enabled;							// skipped (done instantly) when false
+	std::function<void()> fn;
+	std::vector<size_t> deps;				// earlier nodes this one has to wait for
+	std::vector<size_t> dependents;
+	double start;							// last run, seconds since run() started
+	double time;							// last run, duration in seconds
+	double avg;								// smoothed duration in seconds
+	uint64_t runs;
+};
+
+// Stages declared in execution order, each with the data it reads + writes. A
+// stage waits for every earlier stage it conflicts with (write/read, read/write
+// or write/write on any resource), stages that do not conflict run concurrently
+// on the JobManager.
+class FrameGraph
+{
+public:
+	FrameGraph();
+	~FrameGraph();
+
+	// Add a stage after the ones added so far, returns its id
+	size_t add(const std::string & name, uint32_t reads, uint32_t writes, std::function<void()> fn, uint8_t flags = FN_NONE);
+	void setEnabled(size_t id, bool enabled);
+
+	// Run every stage once, returns when all are done
+	void run();
+
+	// Log the stages, their dependencies + timings of the last run
+	void dump() const;
+
+	const std::vector<FrameNode> & getNodes() const;
+	double getTime() const;					// duration of the last run() in seconds
+private:
+	void launch(size_t id);
+	void execute(size_t id);
+	void finish(size_t id);
+
+	std::vector<FrameNode> m_nodes;
+	std::unique_ptr<std::atomic<int>[]> m_remaining;	// unfinished deps per node during run()
+	std::atomic<size_t> m_done;
+	std::mutex m_mainMutex;
+	std::vector<size_t> m_mainReady;		// FN_MAIN nodes ready to run
+	double m_t0;
+	double m_time;
+};
+
+#endif // FRAME_GRAPH_H
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "frame_pacer.h"
+#include <cmath>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include "clock.h"
+
+// Spin margin bounds in seconds
+#define SPIN_MIN 0.0005
+#define SPIN_MAX 0.004
+
+FramePacer::FramePacer(
+	size_t window
+) :
+	m_period(0.0),
+	m_next(0.0),
+	m_last(0.0),
+	m_spin(0.002),
+	m_times(std::max(window, static_cast<size_t>(1)), 0.0),
+	m_head(0),
+	m_count(0),
+	m_late(0),
+	m_stats(),
+	m_statsMutex()
+{
+	m_last = now();
+	m_next = m_last;
+}
+
+FramePacer::~FramePacer()
+{
+
+}
+
+void FramePacer::setTarget(float fps)
+{
+	double period = (fps > 0.0f) ? 1.0 / static_cast<double>(fps) : 0.0;
+
+	// Restart the deadline chain on change
+	if (period != m_period)
+	{
+		m_period = period;
+		m_next = now() + m_period;
+	}
+}
+
+void FramePacer::wait()
+{
+	if (m_period > 0.0)
+	{
+		double t = now();
+
+		// Sleep until just before the deadline, the scheduler tends to oversleep
+		double sleep = m_next - t - m_spin;
+		if (sleep > 0.0)
+		{
+			std::this_thread::sleep_for(std::chrono::duration<double>(sleep));
+
+			// Follow the observed overshoot, leaving some headroom
+			double overshoot = (now() - t) - sleep;
+			m_spin = std::min(std::max(m_spin * 0.9 + (overshoot + SPIN_MIN) * 0.1, SPIN_MIN), SPIN_MAX);
+		}
+
+		// Spin the rest
+		while (now() < m_next)
+		{
+			std::this_thread::yield();
+		}
+
+		// Next deadline, re-anchor instead of bursting when a frame ran late
+		m_next += m_period;
+		t = now();
+		if (m_next < t)
+		{
+			m_next = t + m_period;
+			m_late++;
+		}
+	}
+
+	double t = now();
+	sample(t - m_last);
+	m_last = t;
+}
+
+FrameStats FramePacer::getStats() const
+{
+	std::lock_guard<std::mutex> lock(m_statsMutex);
+	return m_stats;
+}
+
+double FramePacer::now() const
+{
+	return Clock::seconds();
+}
+
+void FramePacer::sample(double frame_time)
+{
+	m_times[m_head] = frame_time;
+	m_head = (m_head + 1) % m_times.size();
+	m_count = std::min(m_count + 1, m_times.size());
+
+	// Recompute stats over the window
+	FrameStats stats = FrameStats();
+	stats.min = m_times[0];
+	stats.max = m_times[0];
+	for (size_t i = 0; i < m_count; i++)
+	{
+		stats.mean += m_times[i];
+		stats.min = std::min(stats.min, m_times[i]);
+		stats.max = std::max(stats.max, m_times[i]);
+	}
+	stats.mean /= static_cast<double>(m_count);
+	for (size_t i = 0; i < m_count; i++)
+	{
+		stats.jitter += (m_times[i] - stats.mean) * (m_times[i] - stats.mean);
+	}
+	stats.jitter = std::sqrt(stats.jitter / static_cast<double>(m_count));
+	stats.fps = (stats.mean > 0.0) ? 1.0 / stats.mean : 0.0;
+	stats.late = m_late;
+
+	std::lock_guard<std::mutex> lock(m_statsMutex);
+	m_stats = stats;
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+struct FrameStats
+{
+	double fps;							// measured frames per second
+	double mean;						// mean frame time in seconds
+	double jitter;						// frame time standard deviation in seconds
+	double min, max;					// frame time extremes in seconds
+	uint64_t late;						// frames that missed their deadline by over a frame
+};
+
+// Frame limiter, sleeps most of the wait and spins the last stretch so that
+// frames hit the target interval without busy-looping the whole frame.
+class FramePacer
+{
+public:
+	FramePacer(
+		size_t window = 120
+	);
+	~FramePacer();
+
+	// Target frame rate, <= 0 renders unlimited (or at vsync rate)
+	void setTarget(float fps);
+
+	// Wait for the next frame deadline + record the frame time
+	void wait();
+
+	FrameStats getStats() const;
+private:
+	double now() const;
+	void sample(double frame_time);
+
+	double m_period;					// target frame interval in seconds, 0 = unlimited
+	double m_next;						// next frame deadline
+	double m_last;						// previous wait() return
+	double m_spin;						// spin margin before the deadline, follows sleep overshoot
+	std::vector<double> m_times;		// ring of recent frame times
+	size_t m_head;
+	size_t m_count;
+	uint64_t m_late;
+	FrameStats m_stats;
+	mutable std::mutex m_statsMutex;	// stats are read from the simulation thread
+};
+
+#endif // FRAME_PACER_H
\ No newline at end of file
@@ -1,15 +1,26 @@
 #include "game.h"
 #include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include <thread>
+#include <chrono>
 #include <SDL2/SDL.h>
 #include "3rdparty/mlibc_log.h"
 #include "input_manager.h"
 #include "display_manager.h"
+#include "render_queue.h"
+#include "clock.h"
 #include "audio_manager.h"
 #include "texture_manager.h"
+#include "sprite.h"
+#include "job_manager.h"
 #include "game_state.h"
 #include "menu_state.h"
 #include "level.h"
 
+// Longest frame time simulated in one go, in seconds
+#define MAX_FRAME_TIME 0.25
+
 mlibc_log_logger * mlibc_log_instance = NULL;
 
 Game::Game(
@@ -18,7 +29,12 @@ Game::Game(
 	m_cfg(cfg),
 	m_run_state(GRS_STOPPED),
 	m_state(nullptr),
-	m_phys()
+	m_phys(),
+	m_pacer(),
+	m_levelQueue(static_cast<size_t>(std::max(cfg.lvl_queue_depth, 0))),
+	m_threaded(false),
+	m_frameGraph(),
+	m_retired()
 {
 	int return_code;
 
@@ -41,6 +57,9 @@ Game::Game(
 	// Init InputManager
 	InputManager::init();
 
+	// Init JobManager (gfx_threads counts the main thread, 0 = all hardware threads)
+	JobManager::init((m_cfg.gfx_threads > 0) ? m_cfg.gfx_threads - 1 : -1);
+
 	// Init DisplayManager (molez resolution = 640x467 in DOS)
 	DisplayManager::init();
 	DisplayManager::load_window(
@@ -48,7 +67,8 @@ Game::Game(
 		m_cfg.win_width,
 		m_cfg.win_height,
 		m_cfg.win_scale,
-		m_cfg.win_fullscreen
+		m_cfg.win_fullscreen,
+		m_cfg.gfx_vsync
 	);
 	DisplayManager::activate_window("molez");
 	DisplayManager::clear(0x00000000);
@@ -84,11 +104,20 @@ Game::~Game()
 {
 	// Destroy GameState
 	delete m_state;
+	for (auto & kv : m_retired)
+	{
+		delete kv.second;
+	}
+
+	// Stop level pre-generation, it reads textures
+	m_levelQueue.stop();
 
 	// Cleanup memory
+	Sprite::unload_sheets();
 	TextureManager::quit();
 	AudioManager::quit();
 	DisplayManager::quit();
+	JobManager::quit();
 	InputManager::quit();
 	SDL_Quit();
 	mlibc_log_free();
@@ -109,43 +138,149 @@ GameRunState_t Game::run()
 	m_run_state = GRS_RUNNING;
 
 	// Fixed timestep physics prepare
-	m_phys.t = 0.0f;
-	m_phys.dt = 1.0f / m_cfg.phy_tickrate;
+	m_phys.tick = 0;
+	m_phys.t = 0.0;
+	m_phys.dt = 1.0 / static_cast<double>(m_cfg.phy_tickrate);
 	m_phys.t_curr = getTimeInSec();				// hires_time_in_seconds()
-	m_phys.t_acc = 0.0f;						// accumulator
+	m_phys.t_acc = 0.0;							// accumulator
+	m_phys.overruns = 0;
+	m_phys.t_dropped = 0.0;
 	m_phys.s_prev = 0.0f;						// previous state
 	m_phys.s_curr = 0.0f;						// current state
 
+	// Pipelined; simulation thread records frames, this thread polls input + renders them
+	m_threaded = m_cfg.phy_threaded;
+	if (m_threaded)
+	{
+		mlibc_inf("Game::run(). Running simulation on its own thread.");
+
+		std::thread sim(&Game::simulate, this);
+		while (m_run_state == GRS_RUNNING)
+		{
+			input();
+
+			// Interpolate from the time the newest snapshot's tick state became current
+			RenderQueue::acquire();
+			double alpha = (getTimeInSec() - RenderQueue::current().time) / m_phys.dt;
+			present(static_cast<float>(alpha));
+
+			// Frame limiter
+			m_pacer.setTarget(m_cfg.gfx_framerate);
+			m_pacer.wait();
+		}
+		sim.join();
+
+		return m_run_state;
+	}
+
+	// Frame stages; SDL + GL calls are tied to this thread, so they run in order on
+	// it, the game state's own stages spread over the JobManager inside simulate
+	if (m_frameGraph.getNodes().empty())
+	{
+		// Poll input first, events are stamped before the frame's ticks are timed
+		m_frameGraph.add("input", FR_NONE, FR_INPUT, [this]() {
+			input();
+		}, FN_MAIN);
+
+		// Fixed timestep, simulate until acc decreases to dt, then the interpolation value for the frame
+		m_frameGraph.add("simulate", FR_INPUT, FR_STATE, [this]() {
+			accumulate();
+			step();
+
+			m_phys.alpha = static_cast<float>(m_phys.t_acc / m_phys.dt);	// interpolation value for state between states
+			m_phys.s_lerp = m_phys.s_curr * m_phys.alpha + m_phys.s_prev * (1.0f - m_phys.alpha);
+		}, FN_MAIN);
+
+		// Record the frame with current interpolated frame state
+		m_frameGraph.add("render prep", FR_STATE, FR_FRAME, [this]() {
+			if (m_state == nullptr)
+			{
+				mlibc_err("Game::run() error! m_state points to NULL!");
+				return;
+			}
+			record(m_phys.s_lerp);
+		}, FN_MAIN);
+
+		// Rasterise it + update the window
+		m_frameGraph.add("raster", FR_FRAME, FR_SCREEN, [this]() {
+			present(m_phys.alpha);
+			collect();
+		}, FN_MAIN);
+	}
+
 	// Run the game and physics
 	while (m_run_state == GRS_RUNNING)
 	{
-		// Fixed timestep, frame prepare
-		float t_new = getTimeInSec();			// newTime
-		float t_frame = t_new - m_phys.t_curr;	// frame time in seconds
-		if (t_frame > 0.25f)
-			t_frame = 0.25f;
-		m_phys.t_curr = t_new;
+		m_frameGraph.run();
 
-		m_phys.t_acc += t_frame;
+		// Frame limiter
+		m_pacer.setTarget(m_cfg.gfx_framerate);
+		m_pacer.wait();
+	}
 
-		// Fixed timestep, simulate until acc decreases to dt
-		while (m_phys.t_acc >= m_phys.dt)
+	return m_run_state;
+}
+
+void Game::accumulate()
+{
+	double t_new = getTimeInSec();			// newTime
+	double t_frame = t_new - m_phys.t_curr;	// frame time in seconds
+	m_phys.t_curr = t_new;
+
+	// Clamp long frames instead of trying to catch up (spiral of death), report the dropped time
+	if (t_frame > MAX_FRAME_TIME)
+	{
+		m_phys.overruns++;
+		m_phys.t_dropped += t_frame - MAX_FRAME_TIME;
+		mlibc_dbg("Game::accumulate(). Frame took %.3fs, dropped %.3fs of simulation (%llu overruns).", t_frame, t_frame - MAX_FRAME_TIME, static_cast<unsigned long long>(m_phys.overruns));
+
+		t_frame = MAX_FRAME_TIME;
+	}
+
+	m_phys.t_acc += t_frame;
+}
+
+void Game::step()
+{
+	while (m_phys.t_acc >= m_phys.dt)
+	{
+		// Apply the input polled up to the wall time this tick ends at
+		InputManager::consume(m_phys.t_curr - m_phys.t_acc + m_phys.dt, m_phys.tick);
+
+		m_phys.s_prev = m_phys.s_curr;
+		update(m_phys.s_curr, static_cast<float>(m_phys.t), static_cast<float>(m_phys.dt));
+		InputManager::end_tick();
+
+		// Derive time from the tick count, nothing accumulates rounding error
+		m_phys.tick++;
+		m_phys.t = static_cast<double>(m_phys.tick) * m_phys.dt;
+		m_phys.t_acc -= m_phys.dt;
+	}
+}
+
+void Game::simulate()
+{
+	while (m_run_state == GRS_RUNNING)
+	{
+		// Fixed timestep, frame prepare
+		accumulate();
+
+		// Nothing to simulate yet, sleep until the next tick is due
+		if (m_phys.t_acc < m_phys.dt)
 		{
-			m_phys.s_prev = m_phys.s_curr;
-			update(m_phys.s_curr, m_phys.t, m_phys.dt);
-			m_phys.t += m_phys.dt;
-			m_phys.t_acc -= m_phys.dt;
+			std::this_thread::sleep_for(std::chrono::duration<double>(m_phys.dt - m_phys.t_acc));
+			continue;
 		}
 
-		// Fixed timestep, frame end
-		m_phys.alpha = m_phys.t_acc / m_phys.dt;	// interpolation value for state between states
-		m_phys.s_lerp = m_phys.s_curr * m_phys.alpha + m_phys.s_prev * (1.0f - m_phys.alpha);
+		// Fixed timestep, simulate until acc decreases to dt (input is polled by the main thread)
+		step();
 
-		// Render with current interpolated frame state
-		render(m_phys.s_lerp);
+		// Snapshot the newest tick state for the render thread
+		m_phys.alpha = static_cast<float>(m_phys.t_acc / m_phys.dt);
+		m_phys.s_lerp = m_phys.s_curr;
+		record(m_phys.s_curr);
+		collect();
 	}
-
-	return m_run_state;
 }
 
 void Game::stop()
@@ -171,27 +306,45 @@ void Game::update(float state, float t, float dt)
 		return;
 	}
 
-	input();
 	m_state->update(state, t, dt);
 }
 
-void Game::render(float state)
+void Game::record(float state)
 {
-	// If m_state == NULL, don't continue
-	if (m_state == nullptr)
-	{
-		mlibc_err("Game::render() error! m_state points to NULL!");
-		return;
-	}
-
-	// Clear window FBO
-	DisplayManager::clear(0x00333333);
+	// Record frame, starting with a window FBO clear
+	RenderQueue::begin();
+	RenderQueue::clear(0x00333333);
 
 	// Render GameState
 	m_state->render(state);
 
-	// Update window FBO
+	// Publish, tick state of this frame is current at t_curr - t_acc
+	RenderQueue::publish(m_phys.t_curr - m_phys.t_acc);
+}
+
+void Game::present(float alpha)
+{
+	// Cull + sort + rasterise newest recorded frame, then update window FBO
+	RenderQueue::acquire();
+	RenderQueue::execute(alpha);
 	DisplayManager::render();
+}
+
+void Game::collect()
+{
+	// Delete retired states once the renderer has moved past frames that refer to them
+	for (size_t i = 0; i < m_retired.size();)
+	{
+		if (RenderQueue::acquired() >= m_retired[i].first)
+		{
+			delete m_retired[i].second;
+			m_retired.erase(m_retired.begin() + i);
+		}
+		else
+		{
+			i++;
+		}
+	}
 
 }
 
@@ -199,61 +352,53 @@ void Game::input()
 {
 	SDL_Event sdl_event;
 
+	// Timestamp + queue events for the simulation, it applies them at the tick they fall into
 	while (SDL_PollEvent(&sdl_event))
 	{
+		InputManager::InputEvent e = { getTimeInSec(), 0, InputManager::IE_KEY_DOWN, 0, 0, 0 };
+
 		switch (sdl_event.type)
 		{
 			case SDL_KEYDOWN:
-			{
-				InputManager::KBOARD[sdl_event.key.keysym.sym] = true;
-			} break;
 			case SDL_KEYUP:
 			{
-				InputManager::KBOARD[sdl_event.key.keysym.sym] = false;
+				if (sdl_event.key.keysym.scancode >= InputManager::KEY_COUNT)
+					continue;
+
+				e.type = (sdl_event.type == SDL_KEYDOWN) ? InputManager::IE_KEY_DOWN : InputManager::IE_KEY_UP;
+				e.code = static_cast<uint16_t>(sdl_event.key.keysym.scancode);
 			} break;
 			case SDL_MOUSEBUTTONDOWN:
-			{
-				switch (sdl_event.button.button)
-				{
-					case SDL_BUTTON_LEFT:	InputManager::MOUSE_L = true; break;
-					case SDL_BUTTON_RIGHT:	InputManager::MOUSE_R = true; break;
-					case SDL_BUTTON_MIDDLE:	InputManager::MOUSE_M = true; break;
-				}
-			} break;
 			case SDL_MOUSEBUTTONUP:
 			{
+				e.type = (sdl_event.type == SDL_MOUSEBUTTONDOWN) ? InputManager::IE_MOUSE_DOWN : InputManager::IE_MOUSE_UP;
 				switch (sdl_event.button.button)
 				{
-					case SDL_BUTTON_LEFT:	InputManager::MOUSE_L = false; break;
-					case SDL_BUTTON_RIGHT:	InputManager::MOUSE_R = false; break;
-					case SDL_BUTTON_MIDDLE:	InputManager::MOUSE_M = false; break;
+					case SDL_BUTTON_LEFT:	e.code = InputManager::MB_LEFT; break;
+					case SDL_BUTTON_RIGHT:	e.code = InputManager::MB_RIGHT; break;
+					case SDL_BUTTON_MIDDLE:	e.code = InputManager::MB_MIDDLE; break;
+					default:				continue;
 				}
 			} break;
 			case SDL_MOUSEMOTION:
 			{
-				int x_t = sdl_event.motion.x / DisplayManager::ACTIVE_WINDOW->scale;
-				int y_t = sdl_event.motion.y / DisplayManager::ACTIVE_WINDOW->scale;
-
-				// Negate camera translation for mouse xy
-				if (DisplayManager::ACTIVE_CAMERA != nullptr)
-				{
-					// Camera translation
-					x_t += DisplayManager::ACTIVE_CAMERA->x;
-					y_t -= DisplayManager::ACTIVE_CAMERA->y;
-
-					// Window offset
-					x_t -= DisplayManager::ACTIVE_WINDOW->width / 2;
-					y_t -= DisplayManager::ACTIVE_WINDOW->height / 2;
-				}
-
-				InputManager::MOUSE_X = x_t;
-				InputManager::MOUSE_Y = y_t;
+				// Camera translation is applied by the consumer
+				e.type = InputManager::IE_MOUSE_MOVE;
+				e.x = sdl_event.motion.x / DisplayManager::ACTIVE_WINDOW->scale;
+				e.y = sdl_event.motion.y / DisplayManager::ACTIVE_WINDOW->scale;
 			} break;
 			case SDL_QUIT:
 			{
 				m_run_state = GRS_STOPPED;
+				continue;
+			} break;
+			default:
+			{
+				continue;
 			} break;
 		}
+
+		InputManager::push(e);
 	}
 }
 
@@ -275,8 +420,10 @@ void Game::setState(GameState * state)
 	// Switch to new state
 	m_state = state;
 
-	// Destroy previous state
-	delete temp;
+	// Destroy previous state once the next published frame has been acquired, older
+	// frames refer to its sprites + setState() may be called from within the state itself
+	if (temp != nullptr)
+		m_retired.push_back(std::make_pair(RenderQueue::published() + 1, temp));
 }
 
 GameState * const Game::getState()
@@ -289,7 +436,22 @@ PhysicsState Game::getPhysState() const
 	return m_phys;
 }
 
-float Game::getTimeInSec() const
+FrameStats Game::getFrameStats() const
+{
+	return m_pacer.getStats();
+}
+
+const FrameGraph & Game::getFrameGraph() const
+{
+	return m_frameGraph;
+}
+
+LevelQueue & Game::getLevelQueue()
+{
+	return m_levelQueue;
+}
+
+double Game::getTimeInSec() const
 {
-	return static_cast<float>(SDL_GetTicks()) / 1000;
+	return Clock::seconds();
 }
\ No newline at end of file
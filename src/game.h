@@ -5,6 +5,11 @@
 #include <vector>
 #include <map>
 #include <stack>
+#include <cstdint>
+#include <atomic>
+#include "frame_pacer.h"
+#include "level_queue.h"
+#include "frame_graph.h"
 
 class GameState;
 
@@ -24,22 +29,32 @@ struct GameConfig
 	bool win_fullscreen;
 	// graphics
 	float gfx_framerate;
+	int gfx_threads;
+	bool gfx_vsync;
 	// audio
 	int sfx_music_vol;
 	int sfx_audio_vol;
 	// physics
 	float phy_tickrate;
+	bool phy_threaded;
+	float phy_fluid_rate;
+	float phy_tick_budget;
+	// level
+	int lvl_queue_depth;
 	// game
 	int n_players;
-	std::vector<std::map<int, std::string>> c_players;
+	std::vector<std::map<int, std::string>> c_players;	// per player, SDL scancode -> action name
 };
 
 struct PhysicsState
 {
-	float t;			// time in seconds
-	float dt;			// timestep in seconds
-	float t_curr;		// current hires_time_in_seconds()
-	float t_acc;		// accumulator for time that has to be simulated
+	uint64_t tick;		// simulated ticks
+	double t;			// time in seconds, tick * dt
+	double dt;			// timestep in seconds
+	double t_curr;		// current Clock::seconds()
+	double t_acc;		// accumulator for time that has to be simulated
+	uint64_t overruns;	// frames clamped to MAX_FRAME_TIME (spiral of death guard)
+	double t_dropped;	// simulation time dropped by the clamps, in seconds
 	float s_curr;		// current physics state
 	float s_prev;		// previous physics state
 	float s_lerp;		// linearly interpolated state
@@ -57,7 +72,6 @@ public:
 	GameRunState_t run();
 	void stop();
 	void update(float state, float t, float dt);
-	void render(float state);
 	void input();
 
 	void setCfg(GameConfig cfg);
@@ -65,12 +79,27 @@ public:
 	void setState(GameState * state);
 	GameState * const getState();
 	PhysicsState getPhysState() const;
-	float getTimeInSec() const;
+	FrameStats getFrameStats() const;
+	LevelQueue & getLevelQueue();
+	const FrameGraph & getFrameGraph() const;
+	double getTimeInSec() const;
 private:
+	void accumulate();
+	void step();
+	void simulate();
+	void record(float state);
+	void present(float alpha);
+	void collect();
+
 	GameConfig & m_cfg;
-	GameRunState_t m_run_state;
+	std::atomic<GameRunState_t> m_run_state;
 	GameState * m_state;
 	PhysicsState m_phys;
+	FramePacer m_pacer;
+	LevelQueue m_levelQueue;				// next rounds' levels, generated in the background
+	bool m_threaded;						// simulation runs on its own thread (fixed at run())
+	FrameGraph m_frameGraph;				// frame stages of the serial loop
+	std::vector<std::pair<uint64_t, GameState *>> m_retired;	// states deleted once no frame refers to them
 };
 
 #endif // GAME_H
\ No newline at end of file
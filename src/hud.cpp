@@ -0,0 +1,152 @@
+#include "hud.h"
+#include <cstring>
+#include "render_queue.h"
+#include "texture_manager.h"
+
+Hud::Hud() :
+	m_texts(),
+	m_raster_count(0)
+{
+
+}
+
+Hud::~Hud()
+{
+
+}
+
+void Hud::set_text(
+	size_t id,
+	int x,
+	int y,
+	int c_width,
+	int c_height,
+	const std::string & text,
+	uint8_t r,
+	uint8_t g,
+	uint8_t b,
+	TextureManager::Font * font
+)
+{
+	HudText & e = get(id);
+
+	// Position + color only affect compositing
+	e.x = x;
+	e.y = y;
+	e.r = r;
+	e.g = g;
+	e.b = b;
+	e.visible = true;
+	e.has_value = false;
+
+	// Re-rasterise only on content, size or font change
+	if (e.text != text || e.c_width != c_width || e.c_height != c_height || e.font != font)
+	{
+		e.text = text;
+		e.c_width = c_width;
+		e.c_height = c_height;
+		e.font = font;
+		raster(e);
+	}
+}
+
+void Hud::set_value(
+	size_t id,
+	int x,
+	int y,
+	int c_width,
+	int c_height,
+	const std::string & label,
+	float value,
+	uint8_t r,
+	uint8_t g,
+	uint8_t b,
+	TextureManager::Font * font
+)
+{
+	HudText & e = get(id);
+
+	// Skip formatting entirely while the value is unchanged
+	if (e.has_value && e.value == value && e.c_width == c_width && e.c_height == c_height && e.font == font)
+	{
+		e.x = x;
+		e.y = y;
+		e.r = r;
+		e.g = g;
+		e.b = b;
+		e.visible = true;
+		return;
+	}
+
+	set_text(id, x, y, c_width, c_height, label + std::to_string(value), r, g, b, font);
+	e.has_value = true;
+	e.value = value;
+}
+
+void Hud::hide(size_t id)
+{
+	if (id < m_texts.size())
+	{
+		m_texts[id].visible = false;
+	}
+}
+
+void Hud::clear()
+{
+	m_texts.clear();
+}
+
+void Hud::render()
+{
+	// Composite cached bitmaps as masked span fills
+	for (auto & e : m_texts)
+	{
+		if (e.visible == false || e.mask.empty())
+			continue;
+
+		RenderQueue::text(RenderQueue::RL_HUD, e.x, e.y, e.w, e.h, e.mask.data(), e.r, e.g, e.b);
+	}
+}
+
+size_t Hud::getRasterCount() const
+{
+	return m_raster_count;
+}
+
+HudText & Hud::get(size_t id)
+{
+	if (id >= m_texts.size())
+	{
+		m_texts.resize(id + 1);
+	}
+
+	return m_texts[id];
+}
+
+void Hud::raster(HudText & e)
+{
+	e.w = e.c_width * static_cast<int>(e.text.size());
+	e.h = e.c_height;
+	e.mask.assign(static_cast<size_t>(e.w * e.h), 0);
+
+	if (e.font == nullptr || e.w <= 0 || e.h <= 0)
+		return;
+
+	// Copy pre-scaled glyph rows side by side into the element bitmap
+	TextureManager::GlyphSet * glyphs = TextureManager::load_glyphs(e.font, e.c_width, e.c_height);
+	for (size_t c_idx = 0; c_idx < e.text.size(); c_idx++)
+	{
+		char c = e.text[c_idx];
+
+		if (glyphs->visible[static_cast<unsigned char>(c)] == false)
+			continue;
+
+		const uint8_t * src = glyphs->mask(c);
+		for (int i = 0; i < e.h; i++)
+		{
+			std::memcpy(&e.mask[c_idx * e.c_width + i * e.w], &src[i * e.c_width], e.c_width);
+		}
+	}
+
+	m_raster_count++;
+}
\ No newline at end of file
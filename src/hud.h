@@ -0,0 +1,93 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace TextureManager
+{
+	struct Font;
+}
+
+struct HudText
+{
+	int x, y;									// on-screen position
+	int c_width, c_height;						// char size
+	uint8_t r, g, b;							// composite color
+	TextureManager::Font * font;				// source font
+	std::string text;							// rasterised content
+	bool has_value;								// value below is valid
+	float value;								// last value given to set_value()
+	bool visible;								// composite on render()
+	int w, h;									// bitmap size
+	std::vector<uint8_t> mask;					// rasterised coverage of the whole string
+
+	HudText() :
+		x(0),
+		y(0),
+		c_width(0),
+		c_height(0),
+		r(255),
+		g(255),
+		b(255),
+		font(nullptr),
+		text(),
+		has_value(false),
+		value(0.0f),
+		visible(false),
+		w(0),
+		h(0),
+		mask()
+	{
+
+	}
+};
+
+// Retained text layer, each element keeps a cached bitmap that is only
+// re-rasterised when its content, char size or font changes.
+class Hud
+{
+public:
+	Hud();
+	~Hud();
+
+	void set_text(
+		size_t id,
+		int x,
+		int y,
+		int c_width,
+		int c_height,
+		const std::string & text,
+		uint8_t r,
+		uint8_t g,
+		uint8_t b,
+		TextureManager::Font * font
+	);
+	void set_value(
+		size_t id,
+		int x,
+		int y,
+		int c_width,
+		int c_height,
+		const std::string & label,
+		float value,
+		uint8_t r,
+		uint8_t g,
+		uint8_t b,
+		TextureManager::Font * font
+	);
+	void hide(size_t id);
+	void clear();
+	void render();
+
+	size_t getRasterCount() const;
+private:
+	HudText & get(size_t id);
+	void raster(HudText & e);
+
+	std::vector<HudText> m_texts;
+	size_t m_raster_count;
+};
+
+#endif // HUD_H
\ No newline at end of file
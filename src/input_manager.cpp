@@ -1,4 +1,7 @@
 #include "input_manager.h"
+#include <atomic>
+#include <cstring>
+#include "display_manager.h"
 #include "3rdparty/mlibc_log.h"
 
 namespace InputManager
@@ -11,18 +14,143 @@ namespace InputManager
 	bool MOUSE_M = false;
 
 	// Keyboard
-	std::map<int, bool> KBOARD;
+	bool KEYS[KEY_COUNT] = {};
+	bool KEYS_PRESSED[KEY_COUNT] = {};
+	bool KEYS_RELEASED[KEY_COUNT] = {};
+
+	// Single producer single consumer ring, head is only written by the consumer + tail by the producer
+	static InputEvent EVENTS[EVENT_CAPACITY];
+	static std::atomic<size_t> HEAD(0);
+	static std::atomic<size_t> TAIL(0);
+	static size_t DROPPED = 0;
+
+	static bool RECORDING = false;
+	static std::vector<InputEvent> RECORDED;
+
+	static void apply(const InputEvent & e)
+	{
+		switch (e.type)
+		{
+			case IE_KEY_DOWN:
+			{
+				KEYS_PRESSED[e.code] = true;
+				KEYS[e.code] = true;
+			} break;
+			case IE_KEY_UP:
+			{
+				if (KEYS[e.code])
+					KEYS_RELEASED[e.code] = true;
+				KEYS[e.code] = false;
+			} break;
+			case IE_MOUSE_DOWN:
+			case IE_MOUSE_UP:
+			{
+				bool down = (e.type == IE_MOUSE_DOWN);
+				switch (e.code)
+				{
+					case MB_LEFT:	MOUSE_L = down; break;
+					case MB_RIGHT:	MOUSE_R = down; break;
+					case MB_MIDDLE:	MOUSE_M = down; break;
+				}
+			} break;
+			case IE_MOUSE_MOVE:
+			{
+				int x_t = e.x;
+				int y_t = e.y;
+
+				// Negate camera translation for mouse xy, the camera belongs to the simulation side
+				if (DisplayManager::ACTIVE_CAMERA != nullptr)
+				{
+					// Camera translation
+					x_t += DisplayManager::ACTIVE_CAMERA->x;
+					y_t -= DisplayManager::ACTIVE_CAMERA->y;
+
+					// Window offset
+					x_t -= DisplayManager::ACTIVE_WINDOW->width / 2;
+					y_t -= DisplayManager::ACTIVE_WINDOW->height / 2;
+				}
+
+				MOUSE_X = x_t;
+				MOUSE_Y = y_t;
+			} break;
+		}
+	}
 
 	// Init
 	void init()
 	{
+		HEAD = 0;
+		TAIL = 0;
+		DROPPED = 0;
+
 		mlibc_inf("InputManager::init().");
 	}
 
 	// Quit (clears memory)
 	void quit()
 	{
+		RECORDED.clear();
+		RECORDED.shrink_to_fit();
+
 		mlibc_inf("InputManager::quit().");
 	}
 
+	bool push(const InputEvent & event)
+	{
+		size_t tail = TAIL.load(std::memory_order_relaxed);
+		if (tail - HEAD.load(std::memory_order_acquire) == EVENT_CAPACITY)
+		{
+			// Simulation stalled, losing input beats blocking the polling thread
+			if (DROPPED++ == 0)
+			{
+				mlibc_err("InputManager::push(). Event ring full, dropping input!");
+			}
+			return false;
+		}
+
+		EVENTS[tail & (EVENT_CAPACITY - 1)] = event;
+		TAIL.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	void consume(double time, uint64_t tick)
+	{
+		size_t head = HEAD.load(std::memory_order_relaxed);
+		size_t tail = TAIL.load(std::memory_order_acquire);
+
+		// Events are in poll order, stop at the first one past this tick
+		while (head != tail)
+		{
+			InputEvent & e = EVENTS[head & (EVENT_CAPACITY - 1)];
+			if (e.time > time)
+				break;
+
+			e.tick = tick;
+			apply(e);
+
+			if (RECORDING)
+				RECORDED.push_back(e);
+
+			head++;
+		}
+
+		HEAD.store(head, std::memory_order_release);
+	}
+
+	void end_tick()
+	{
+		std::memset(KEYS_PRESSED, 0, sizeof(KEYS_PRESSED));
+		std::memset(KEYS_RELEASED, 0, sizeof(KEYS_RELEASED));
+	}
+
+	void set_recording(bool enabled)
+	{
+		RECORDING = enabled;
+	}
+
+	const std::vector<InputEvent> & get_recording()
+	{
+		return RECORDED;
+	}
+
 }
\ No newline at end of file
@@ -1,19 +1,52 @@
 #ifndef INPUT_MANAGER_H
 #define INPUT_MANAGER_H
 
-#include <map>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 namespace InputManager
 {
 
+	enum InputEvent_t : uint8_t
+	{
+		IE_KEY_DOWN = 0,
+		IE_KEY_UP = 1,
+		IE_MOUSE_DOWN = 2,
+		IE_MOUSE_UP = 3,
+		IE_MOUSE_MOVE = 4
+	};
+
+	enum MouseButton_t : uint8_t
+	{
+		MB_LEFT = 0,
+		MB_RIGHT = 1,
+		MB_MIDDLE = 2
+	};
+
+	struct InputEvent
+	{
+		double time;						// Clock::seconds() when polled
+		uint64_t tick;						// simulation tick that consumed it
+		InputEvent_t type;
+		uint16_t code;						// scancode or MouseButton_t
+		int32_t x, y;						// mouse position, window pixels / scale
+	};
+
 	// Mouse
 	extern int MOUSE_X, MOUSE_Y;
 	extern bool MOUSE_L;
 	extern bool MOUSE_R;
 	extern bool MOUSE_M;
 
-	// Keyboard
-	extern std::map<int, bool> KBOARD;
+	// Keyboard, held state indexed by SDL scancode
+	const size_t KEY_COUNT = 512;			// SDL_NUM_SCANCODES
+	extern bool KEYS[KEY_COUNT];
+	extern bool KEYS_PRESSED[KEY_COUNT];	// went down (or auto-repeated) during the tick, kept even if released before it ended
+	extern bool KEYS_RELEASED[KEY_COUNT];	// went up during the tick
+
+	// Events between the polling thread (producer) + the simulation (consumer)
+	const size_t EVENT_CAPACITY = 1024;		// power of two
 
 	// Init
 	void init();
@@ -21,6 +54,19 @@ namespace InputManager
 	// Quit (clears memory)
 	void quit();
 
+	// Producer, queue a polled event, false (event dropped) when the ring is full
+	bool push(const InputEvent & event);
+
+	// Consumer, apply the events polled up to time to the key + mouse state
+	void consume(double time, uint64_t tick);
+
+	// Consumer, clear the pressed/released latches after a tick
+	void end_tick();
+
+	// Record consumed events (tick stamped), for replays
+	void set_recording(bool enabled);
+	const std::vector<InputEvent> & get_recording();
+
 }
 
 
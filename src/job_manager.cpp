@@ -0,0 +1,338 @@
+#include "job_manager.h"
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+#include "clock.h"
+#include "3rdparty/mlibc_log.h"
+
+namespace JobManager
+{
+
+	// Per-thread job deque, the owner pushes + pops at the back (LIFO, cache warm),
+	// thieves take from the front (FIFO, oldest + usually largest work)
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	// Queue 0 is shared by the threads that are not workers (main + simulation thread)
+	static std::vector<Queue *> QUEUES;
+	static std::vector<std::thread> WORKERS;
+	static thread_local size_t QUEUE = 0;
+
+	// Sleeping workers wait for QUEUED to become non-zero
+	static std::atomic<size_t> QUEUED(0);
+	static std::mutex SLEEP_MUTEX;
+	static std::condition_variable SLEEP_CV;
+	static std::atomic<bool> RUNNING(false);
+
+	static void push(Job && job)
+	{
+		Queue * q = QUEUES[QUEUE];
+		{
+			std::lock_guard<std::mutex> lock(q->mutex);
+			q->jobs.push_back(std::move(job));
+			QUEUED++;
+		}
+
+		// Lock pairs with the sleeping worker's predicate check, so the wakeup cannot be missed
+		{
+			std::lock_guard<std::mutex> lock(SLEEP_MUTEX);
+		}
+		SLEEP_CV.notify_one();
+	}
+
+	// Own queue first, then steal round-robin starting after it
+	static bool pop(Job & job)
+	{
+		size_t n = QUEUES.size();
+		for (size_t k = 0; k < n; k++)
+		{
+			size_t idx = (QUEUE + k) % n;
+			Queue * q = QUEUES[idx];
+
+			std::lock_guard<std::mutex> lock(q->mutex);
+			if (q->jobs.empty())
+				continue;
+
+			if (k == 0)
+			{
+				job = std::move(q->jobs.back());
+				q->jobs.pop_back();
+			}
+			else
+			{
+				job = std::move(q->jobs.front());
+				q->jobs.pop_front();
+			}
+
+			QUEUED--;
+			return true;
+		}
+
+		return false;
+	}
+
+	static void release(Counter * counter)
+	{
+		// Decrement + take the dependants under the lock, wait() takes it once more before
+		// returning, so the counter is not touched after its owner may have destroyed it
+		std::vector<Job> waiting;
+		{
+			std::lock_guard<std::mutex> lock(counter->mutex);
+			if (counter->pending.fetch_sub(1) == 1)
+				waiting.swap(counter->waiting);
+		}
+
+		// Last job of the counter, hand its dependants over to the queues
+		for (auto & job : waiting)
+		{
+			push(std::move(job));
+		}
+	}
+
+	static void execute(Job & job)
+	{
+		job.fn();
+
+		if (job.counter)
+			release(job.counter);
+	}
+
+	static void worker(size_t queue)
+	{
+		QUEUE = queue;
+
+		while (RUNNING)
+		{
+			Job job;
+			if (pop(job))
+			{
+				execute(job);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(SLEEP_MUTEX);
+			SLEEP_CV.wait(lock, []() { return RUNNING == false || QUEUED > 0; });
+		}
+	}
+
+	// Init
+	void init(int n_workers)
+	{
+		if (n_workers < 0)
+		{
+			unsigned int hw = std::thread::hardware_concurrency();
+			n_workers = (hw > 1) ? static_cast<int>(hw) - 1 : 0;
+		}
+
+		RUNNING = true;
+		QUEUED = 0;
+		QUEUES.push_back(new Queue());
+		for (int i = 0; i < n_workers; i++)
+		{
+			QUEUES.push_back(new Queue());
+		}
+		for (int i = 0; i < n_workers; i++)
+		{
+			WORKERS.push_back(std::thread(worker, static_cast<size_t>(i + 1)));
+		}
+
+		mlibc_inf("JobManager::init(). Started %zu worker thread(s).", WORKERS.size());
+	}
+
+	// Quit (joins worker threads)
+	void quit()
+	{
+		{
+			std::lock_guard<std::mutex> lock(SLEEP_MUTEX);
+			RUNNING = false;
+		}
+		SLEEP_CV.notify_all();
+
+		for (auto & w : WORKERS)
+		{
+			w.join();
+		}
+		WORKERS.clear();
+
+		// Jobs nobody waited for still run, on the quitting thread
+		Job job;
+		while (pop(job))
+		{
+			execute(job);
+		}
+
+		for (auto q : QUEUES)
+		{
+			delete q;
+		}
+		QUEUES.clear();
+
+		mlibc_inf("JobManager::quit().");
+	}
+
+	size_t worker_count()
+	{
+		return WORKERS.size();
+	}
+
+	void run(const std::function<void()> & fn, Counter * counter, Counter * dependency)
+	{
+		if (counter)
+			counter->pending++;
+
+		Job job = { fn, counter };
+
+		// Not initialised, run inline
+		if (QUEUES.empty())
+		{
+			if (dependency)
+				wait(dependency);
+			execute(job);
+			return;
+		}
+
+		// Park on the dependency, re-checked under its lock so a concurrent release cannot miss the job
+		if (dependency)
+		{
+			std::lock_guard<std::mutex> lock(dependency->mutex);
+			if (dependency->pending > 0)
+			{
+				dependency->waiting.push_back(std::move(job));
+				return;
+			}
+		}
+
+		push(std::move(job));
+	}
+
+	void wait(Counter * counter)
+	{
+		// Participate instead of blocking, also keeps nested waits inside jobs deadlock free
+		while (counter->pending > 0)
+		{
+			if (help() == false)
+				std::this_thread::yield();
+		}
+
+		// The releasing thread may still hold the lock, the counter is free to go once it is out
+		std::lock_guard<std::mutex> lock(counter->mutex);
+	}
+
+	bool help()
+	{
+		Job job;
+		if (QUEUES.empty() || pop(job) == false)
+			return false;
+
+		execute(job);
+		return true;
+	}
+
+	void parallel_for(size_t n, const std::function<void(size_t)> & fn, size_t grain)
+	{
+		// Default to ~4 ranges per thread, enough slack for stealing to even out uneven items
+		if (grain == 0)
+		{
+			grain = std::max<size_t>(n / ((WORKERS.size() + 1) * 4), 1);
+		}
+
+		// Nothing to share, run inline
+		if (WORKERS.empty() || n <= grain)
+		{
+			for (size_t i = 0; i < n; i++)
+				fn(i);
+			return;
+		}
+
+		// Queue all but the first range, the calling thread runs that one right away
+		Counter counter;
+		for (size_t begin = grain; begin < n; begin += grain)
+		{
+			size_t end = std::min(begin + grain, n);
+			run([&fn, begin, end]() {
+				for (size_t i = begin; i < end; i++)
+					fn(i);
+			}, &counter);
+		}
+
+		for (size_t i = 0; i < grain; i++)
+			fn(i);
+
+		wait(&counter);
+	}
+
+	void benchmark(int max_workers)
+	{
+		// Re-initialised per worker count below
+		bool was_running = RUNNING;
+		int prev_workers = static_cast<int>(WORKERS.size());
+		if (was_running)
+			quit();
+
+		const size_t N_EMPTY = 100000;
+		const size_t N_ITEMS = 4096;
+		const size_t ITEM_WORK = 20000;
+		double t_single = 0.0;
+
+		printf("JobManager::benchmark(). %u hardware threads\n", std::thread::hardware_concurrency());
+		printf("%8s %14s %14s %14s %10s\n", "threads", "job ns", "dep chain ns", "for ms", "speedup");
+
+		for (int threads = 1; threads <= max_workers; threads *= 2)
+		{
+			init(threads - 1);
+
+			// Scheduling overhead, empty jobs submitted + waited on from the main thread
+			Counter empty;
+			double t0 = Clock::seconds();
+			for (size_t i = 0; i < N_EMPTY; i++)
+			{
+				run([]() {}, &empty);
+			}
+			wait(&empty);
+			double t_empty = Clock::seconds() - t0;
+
+			// Dependency overhead, a chain of jobs each released by the previous one
+			const size_t N_CHAIN = 10000;
+			std::vector<Counter> chain(N_CHAIN);
+			t0 = Clock::seconds();
+			for (size_t i = 0; i < N_CHAIN; i++)
+			{
+				run([]() {}, &chain[i], (i > 0) ? &chain[i - 1] : nullptr);
+			}
+			wait(&chain[N_CHAIN - 1]);
+			double t_chain = Clock::seconds() - t0;
+
+			// Scaling, compute bound parallel_for
+			std::vector<uint32_t> out(N_ITEMS);
+			t0 = Clock::seconds();
+			parallel_for(N_ITEMS, [&out, ITEM_WORK](size_t i) {
+				uint32_t x = static_cast<uint32_t>(i) + 1;
+				for (size_t k = 0; k < ITEM_WORK; k++)
+				{
+					x ^= x << 13;
+					x ^= x >> 17;
+					x ^= x << 5;
+				}
+				out[i] = x;
+			}, 16);
+			double t_for = Clock::seconds() - t0;
+
+			if (threads == 1)
+				t_single = t_for;
+
+			printf("%8d %14.1f %14.1f %14.2f %10.2f\n", threads, t_empty * 1e9 / N_EMPTY, t_chain * 1e9 / N_CHAIN, t_for * 1e3, t_single / t_for);
+
+			quit();
+		}
+
+		if (was_running)
+			init(prev_workers);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef JOB_MANAGER_H
+#define JOB_MANAGER_H
+
+#include <cstddef>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <functional>
+
+namespace JobManager
+{
+
+	struct Counter;
+
+	struct Job
+	{
+		std::function<void()> fn;
+		Counter * counter;					// decremented when fn returns, may be null
+	};
+
+	// Outstanding job count; a counter reaching zero releases the jobs waiting on it
+	struct Counter
+	{
+		std::atomic<int> pending;
+		std::mutex mutex;					// guards waiting
+		std::vector<Job> waiting;			// jobs submitted with this counter as dependency
+
+		Counter() :
+			pending(0),
+			mutex(),
+			waiting()
+		{
+
+		}
+	};
+
+	// Init (n_workers < 0 uses one worker per extra hardware thread)
+	void init(int n_workers = -1);
+
+	// Quit (joins worker threads)
+	void quit();
+
+	// Worker threads, not counting the calling thread
+	size_t worker_count();
+
+	// Queue fn, counter (if any) is incremented now + decremented once fn ran.
+	// With a dependency the job is held back until that counter reaches zero.
+	void run(const std::function<void()> & fn, Counter * counter = nullptr, Counter * dependency = nullptr);
+
+	// Run queued jobs on the calling thread until counter reaches zero
+	void wait(Counter * counter);
+
+	// Run one queued job on the calling thread, false if there was none
+	bool help();
+
+	// Run fn(i) for i in [0..n) as jobs of grain indices (0 = a few jobs per thread), the calling thread
+	// participates, returns when all are done. Any thread may submit, including jobs themselves.
+	void parallel_for(size_t n, const std::function<void(size_t)> & fn, size_t grain = 0);
+
+	// Print scheduling overhead + parallel_for scaling for 1..max_workers workers
+	void benchmark(int max_workers = 32);
+
+}
+
+#endif // JOB_MANAGER_H
\ No newline at end of file
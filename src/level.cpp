@@ -1,7 +1,10 @@
 #include "level.h"
 #include <random>
+#include <algorithm>
+#include <limits>
+#include <cmath>
 #include "3rdparty/mlibc_log.h"
-#include "display_manager.h"
+#include "render_queue.h"
 #include "texture_manager.h"
 #include "math.h"
 
@@ -12,7 +15,15 @@ Level::Level(
 	m_width(m_cfg.width),
 	m_height(m_cfg.height),
 	m_simplex(m_cfg.seed),
+	m_rng(m_cfg.seed),
+	m_dist8(0, 255),
+	m_dist32(),
+	m_progress(0.0f),
+	m_cancel(false),
 	m_bitmap(m_width * m_height),
+	m_argb(m_width * m_height, 0x00000000),
+	m_rowGen(m_height, 1),
+	m_gen(1),
 	m_fluid()
 {
 
@@ -31,10 +42,17 @@ void Level::gen()
 	m_fluid.clear();
 	m_bitmap.clear();
 	m_bitmap.resize(m_width * m_height);
+	m_argb.assign(m_width * m_height, 0x00000000);
+	m_rowGen.assign(m_height, m_gen);
 
 	// Generate level
 	for (int32_t y = 0; y < m_height; y++)
 	{
+		// Stop early when cancelled, the level is left incomplete
+		if (m_cancel)
+			return;
+		m_progress = 0.8f * static_cast<float>(y) / static_cast<float>(m_height);
+
 		for (int32_t x = 0; x < m_width; x++)
 		{
 			// Get pixel at x,y
@@ -46,7 +64,7 @@ void Level::gen()
 			p->n = 0;
 			p->m = M_VOID;
 			p->t = T_NULL;
-			p->argb = 0x00000000;
+			setArgb(p, 0x00000000);
 
 			// Gen noise value at x,y in range 0..1
 			float n_val = m_simplex.noise(x * m_cfg.n_scale, y * m_cfg.n_scale);
@@ -76,9 +94,11 @@ void Level::gen()
 
 	// Gen objects
 	genObject();
+	m_progress = 0.9f;
 
 	// Gen fluids
 	genFluid();
+	m_progress = 1.0f;
 
 	mlibc_inf("Level::gen(%u). Level generated! Type: %u, width: %zu, height: %zu", m_cfg.seed, m_cfg.type, m_width, m_height);
 }
@@ -89,14 +109,14 @@ void Level::genObject()
 	for (size_t i = 0; i < 128; i++)
 	{
 		// Gen random value, range 0..255
-		uint8_t r_val = static_cast<uint8_t>(RNG_DIST8(RNG));
+		uint8_t r_val = static_cast<uint8_t>(m_dist8(m_rng));
 
 		// Gen object on chance
 		if (r_val < m_cfg.object_n)
 		{
 			// Get x,y
-			int32_t x = RNG_DIST32(RNG) % m_width;
-			int32_t y = RNG_DIST32(RNG) % m_height;
+			int32_t x = m_dist32(m_rng) % m_width;
+			int32_t y = m_dist32(m_rng) % m_height;
 
 			// Get pixel at x,y
 			Pixel * p = &m_bitmap[x + y * m_width];
@@ -113,15 +133,15 @@ void Level::genFluid()
 	for (size_t i = 0; i < 128; i++)
 	{
 		// Gen random value, range 0..255
-		uint8_t r_val = static_cast<uint8_t>(RNG_DIST8(RNG));
+		uint8_t r_val = static_cast<uint8_t>(m_dist8(m_rng));
 
 		// Gen water on chance
 		if (r_val < m_cfg.water_n)
 		{
 			// Get radius + x,y
-			uint8_t r = static_cast<uint8_t>(RNG_DIST8(RNG) % 16) + 8;
-			int32_t x = RNG_DIST32(RNG) % m_width;
-			int32_t y = RNG_DIST32(RNG) % m_height;
+			uint8_t r = static_cast<uint8_t>(m_dist8(m_rng) % 16) + 8;
+			int32_t x = m_dist32(m_rng) % m_width;
+			int32_t y = m_dist32(m_rng) % m_height;
 
 			// Get pixel at x,y
 			Pixel * p = &m_bitmap[x + y * m_width];
@@ -139,15 +159,15 @@ void Level::genFluid()
 	for (size_t i = 0; i < 128; i++)
 	{
 		// Gen random value, range 0..255
-		uint8_t r_val = static_cast<uint8_t>(RNG_DIST8(RNG));
+		uint8_t r_val = static_cast<uint8_t>(m_dist8(m_rng));
 
 		// Gen lava on chance
 		if (r_val < m_cfg.lava_n)
 		{
 			// Get radius + x,y
-			uint8_t r = static_cast<uint8_t>(RNG_DIST8(RNG) % 16) + 8;
-			int32_t x = RNG_DIST32(RNG) % m_width;
-			int32_t y = RNG_DIST32(RNG) % m_height;
+			uint8_t r = static_cast<uint8_t>(m_dist8(m_rng) % 16) + 8;
+			int32_t x = m_dist32(m_rng) % m_width;
+			int32_t y = m_dist32(m_rng) % m_height;
 
 			// Get pixel at x,y
 			Pixel * p = &m_bitmap[x + y * m_width];
@@ -164,12 +184,47 @@ void Level::regen(uint32_t seed)
 
 	// Re-seed noise generator(s) + set cfg seed
 	m_simplex.reseed(seed);
+	m_rng.seed(seed);
 	m_cfg.seed = seed;
+	m_progress = 0.0f;
 
 	// Re-generate the level
 	gen();
 }
 
+void Level::cancel()
+{
+	m_cancel = true;
+}
+
+bool Level::isCancelled() const
+{
+	return m_cancel;
+}
+
+float Level::getProgress() const
+{
+	return m_progress;
+}
+
+void Level::swap(Level & other)
+{
+	// Swap generated contents, pixel + fluid pointers stay valid as vector storage is swapped.
+	// m_cfg is copied instead, callers keep pointers into it (menu items).
+	m_cfg = other.m_cfg;
+	std::swap(m_width, other.m_width);
+	std::swap(m_height, other.m_height);
+	std::swap(m_simplex, other.m_simplex);
+	std::swap(m_rng, other.m_rng);
+	m_bitmap.swap(other.m_bitmap);
+	m_argb.swap(other.m_argb);
+	m_fluid.swap(other.m_fluid);
+
+	// Everything changed, continue our own generation count so renders re-copy all rows
+	m_rowGen.assign(m_height, m_gen);
+	m_progress = 1.0f;
+}
+
 void Level::alter(Material_t m, Texture_t t, uint8_t r, int x, int y, bool edit)
 {
 	// Calculate start coords
@@ -207,6 +262,141 @@ void Level::alter(Material_t m, Texture_t t, uint8_t r, int x, int y, bool edit)
 	}
 }
 
+void Level::alter(const std::vector<Crater> & craters, bool edit)
+{
+	for (auto & c : craters)
+	{
+		// Clip the crater's bounding box once instead of testing every pixel
+		int32_t x_start = std::max(c.x - c.r, 0);
+		int32_t y_start = std::max(c.y - c.r, 0);
+		int32_t x_end = std::min(c.x + c.r, m_width);
+		int32_t y_end = std::min(c.y + c.r, m_height);
+		int32_t r2 = c.r * c.r;
+
+		// Plain textures are looked up once per crater, rock (random per pixel) + fluids take the full resample
+		TextureManager::Texture * tex = nullptr;
+		if (c.t != T_NULL && c.t != T_ROCK && c.t != T_WATER && c.t != T_LAVA)
+		{
+			auto loaded = TextureManager::LOADED_TEXTURES.find(sampleTexture(c.t));
+			if (loaded != TextureManager::LOADED_TEXTURES.end())
+			{
+				tex = loaded->second;
+			}
+		}
+
+		for (int32_t i = y_start; i < y_end; i++)
+		{
+			int32_t dy2 = (i - c.y) * (i - c.y);
+
+			for (int32_t j = x_start; j < x_end; j++)
+			{
+				// Same test as alter(), (int)sqrt(d2) < r <=> d2 < r * r
+				if ((j - c.x) * (j - c.x) + dy2 >= r2)
+					continue;
+
+				Pixel * p = &m_bitmap[j + i * m_width];
+
+				// Do not allow altering indestructible data in non-editor mode
+				if (edit == false && p->m == M_SOLID_ID)
+					continue;
+
+				p->m = c.m;
+				p->t = c.t;
+
+				if (tex == nullptr)
+				{
+					samplePixel(p);
+					continue;
+				}
+
+				// Alpha 0x00 is transparency
+				int32_t argb = tex->data[(p->x % tex->width) + (p->y % tex->height) * tex->width];
+				if ((argb & 0xFF000000) != 0)
+				{
+					setArgb(p, argb);
+				}
+			}
+		}
+	}
+}
+
+bool Level::isSolid(int x, int y) const
+{
+	// Outside the level is empty
+	if (x < 0 || x >= m_width || y < 0 || y >= m_height)
+		return false;
+
+	Material_t m = m_bitmap[x + y * m_width].m;
+	return m == M_SOLID || m == M_SOLID_ID;
+}
+
+bool Level::raycast(const Math::vec2 & from, const Math::vec2 & to, LevelHit & hit) const
+{
+	// Grid traversal (Amanatides & Woo), visits every pixel the segment touches in order
+	int32_t x = static_cast<int32_t>(std::floor(from.x));
+	int32_t y = static_cast<int32_t>(std::floor(from.y));
+	int32_t x_end = static_cast<int32_t>(std::floor(to.x));
+	int32_t y_end = static_cast<int32_t>(std::floor(to.y));
+
+	Math::vec2 d = to - from;
+	int32_t step_x = (d.x > 0.0f) ? 1 : -1;
+	int32_t step_y = (d.y > 0.0f) ? 1 : -1;
+
+	// Segment parameter of the next x / y pixel boundary + parameter step per pixel
+	const float inf = std::numeric_limits<float>::infinity();
+	float t_dx = (d.x != 0.0f) ? std::abs(1.0f / d.x) : inf;
+	float t_dy = (d.y != 0.0f) ? std::abs(1.0f / d.y) : inf;
+	float t_x = (d.x != 0.0f) ? ((step_x > 0) ? (x + 1 - from.x) : (from.x - x)) * t_dx : inf;
+	float t_y = (d.y != 0.0f) ? ((step_y > 0) ? (y + 1 - from.y) : (from.y - y)) * t_dy : inf;
+
+	// Starting inside solid ground, push back against the direction of travel
+	if (isSolid(x, y))
+	{
+		float len = d.length();
+		hit.x = x;
+		hit.y = y;
+		hit.pos = from;
+		hit.normal = (len > 0.0f) ? d * (-1.0f / len) : Math::vec2(0.0f, 1.0f);
+		return true;
+	}
+
+	while (x != x_end || y != y_end)
+	{
+		float t;
+		Math::vec2 normal;
+
+		if (t_x < t_y)
+		{
+			t = t_x;
+			t_x += t_dx;
+			x += step_x;
+			normal = Math::vec2(static_cast<float>(-step_x), 0.0f);
+		}
+		else
+		{
+			t = t_y;
+			t_y += t_dy;
+			y += step_y;
+			normal = Math::vec2(0.0f, static_cast<float>(-step_y));
+		}
+
+		// Floating point drift can overshoot the last pixel
+		if (t > 1.0f)
+			break;
+
+		if (isSolid(x, y))
+		{
+			hit.x = x;
+			hit.y = y;
+			hit.pos = from + d * t;
+			hit.normal = normal;
+			return true;
+		}
+	}
+
+	return false;
+}
+
 void Level::draw(Material_t m, Texture_t t, int x, int y)
 {
 	// Get texture for material
@@ -236,7 +426,7 @@ void Level::draw(Material_t m, Texture_t t, int x, int y)
 			if (a != 0x00)
 			{
 				p->m = m;
-				p->argb = argb;
+				setArgb(p, argb);
 			}
 
 			// Inc texcoord x
@@ -286,7 +476,7 @@ void Level::samplePixel(Pixel * p)
 	}
 
 	// Assign new RGB values
-	p->argb = argb;
+	setArgb(p, argb);
 }
 
 std::string Level::sampleTexture(Texture_t t)
@@ -298,7 +488,7 @@ std::string Level::sampleTexture(Texture_t t)
 		case T_ROCK:
 		{
 			// Gen random value, range 1..ROCK_MAX
-			uint8_t r_val = static_cast<uint8_t>(RNG_DIST8(RNG)) % 3;
+			uint8_t r_val = static_cast<uint8_t>(m_dist8(m_rng)) % 3;
 			r_val++;
 
 			// Return rock texture name
@@ -406,7 +596,7 @@ void Level::update(float state, float t, float dt)
 			// Copy values to new fluid pixel
 			p_n->m = p_f->m;
 			p_n->t = p_f->t;
-			p_n->argb = p_f->argb;
+			setArgb(p_n, p_f->argb);
 
 			// Reset current fluid pixel to M_VOID & T_AIR
 			p_f->m = M_VOID;
@@ -441,20 +631,10 @@ void Level::update(float state, float t, float dt)
 
 void Level::render(float state)
 {
-	for (size_t i = 0; i < m_bitmap.size(); i++)
-	{
-		// Get pixel at x,y
-		auto & p = m_bitmap[i];
-
-		// Decode argb to rgba components
-		auto a = (p.argb & 0xFF000000) >> 24;
-		auto r = (p.argb & 0x00FF0000) >> 16;
-		auto g = (p.argb & 0x0000FF00) >> 8;
-		auto b = (p.argb & 0x000000FF);
-
-		// Set pixel to window fbo at x,y
-		DisplayManager::set_pixel(p.x, p.y, r, g, b, a, false);
-	}
+	// Whole bitmap as a single image, blended with per-pixel alpha. Rows changed
+	// since a snapshot's last capture are re-copied, later changes go to the next gen.
+	RenderQueue::level(RenderQueue::RL_LEVEL, 0, 0, m_width, m_height, m_argb.data(), false, m_rowGen.data(), m_gen);
+	m_gen++;
 }
 
 void Level::setCfg(LevelConfig cfg)
@@ -465,4 +645,12 @@ void Level::setCfg(LevelConfig cfg)
 LevelConfig & Level::getCfg()
 {
 	return m_cfg;
+}
+
+void Level::setArgb(Pixel * p, int32_t argb)
+{
+	// Keep the contiguous color plane in sync with the pixel
+	p->argb = argb;
+	m_argb[p->x + p->y * m_width] = argb;
+	m_rowGen[p->y] = m_gen;
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <cstdint>
+#include <random>
+#include <atomic>
 #include "math.h"
 
 using namespace Math;
@@ -41,6 +43,21 @@ struct Pixel
 	int32_t argb;					// color, ARGB
 };
 
+struct Crater
+{
+	int32_t x, y;					// center
+	uint8_t r;						// radius
+	Material_t m;					// material to fill with
+	Texture_t t;					// texture to fill with
+};
+
+struct LevelHit
+{
+	int32_t x, y;					// first solid pixel along the segment
+	Math::vec2 pos;					// point where the segment enters that pixel
+	Math::vec2 normal;				// face of the pixel that was crossed, axis aligned
+};
+
 struct LevelConfig
 {
 	uint32_t seed;					// initial seed
@@ -66,7 +83,14 @@ public:
 	void genObject();
 	void genFluid();
 	void regen(uint32_t seed);
+	void cancel();
+	bool isCancelled() const;
+	float getProgress() const;
+	void swap(Level & other);
 	void alter(Material_t m, Texture_t t, uint8_t r, int x, int y, bool edit = false);
+	void alter(const std::vector<Crater> & craters, bool edit = false);
+	bool isSolid(int x, int y) const;
+	bool raycast(const Math::vec2 & from, const Math::vec2 & to, LevelHit & hit) const;
 	void draw(Material_t m, Texture_t t, int x, int y);
 	void samplePixel(Pixel * p);
 	std::string sampleTexture(Texture_t t);
@@ -76,11 +100,21 @@ public:
 	void setCfg(LevelConfig cfg);
 	LevelConfig & getCfg();
 private:
+	void setArgb(Pixel * p, int32_t argb);
+
 	LevelConfig m_cfg;
 	int32_t m_width;
 	int32_t m_height;
 	SimplexGen m_simplex;
+	std::mt19937 m_rng;				// own RNG, levels can generate on other threads
+	std::uniform_int_distribution<> m_dist8;
+	std::uniform_int_distribution<> m_dist32;
+	std::atomic<float> m_progress;	// gen() progress, 0..1
+	std::atomic<bool> m_cancel;		// stop gen() early
 	std::vector<Pixel> m_bitmap;
+	std::vector<int32_t> m_argb;	// contiguous copy of m_bitmap colors for rendering
+	std::vector<uint32_t> m_rowGen;	// m_gen of the last m_argb change per row
+	uint32_t m_gen;					// render generation, bumped after each render()
 	std::vector<Pixel *> m_fluid;
 };
 
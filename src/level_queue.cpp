@@ -0,0 +1,169 @@
+#include "level_queue.h"
+#include <SDL2/SDL.h>
+#include "3rdparty/mlibc_log.h"
+
+LevelQueue::LevelQueue(
+	size_t depth
+) :
+	m_depth(depth),
+	m_cfg(),
+	m_hasCfg(false),
+	m_nextSeed(0),
+	m_todo(),
+	m_ready(),
+	m_current(nullptr),
+	m_thread(),
+	m_mutex(),
+	m_cvTodo(),
+	m_running(true)
+{
+
+}
+
+LevelQueue::~LevelQueue()
+{
+	stop();
+}
+
+void LevelQueue::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running = false;
+		if (m_current)
+			m_current->cancel();
+	}
+	m_cvTodo.notify_all();
+
+	if (m_thread.joinable())
+		m_thread.join();
+
+	for (auto level : m_todo)
+		delete level;
+	for (auto level : m_ready)
+		delete level;
+	m_todo.clear();
+	m_ready.clear();
+	m_hasCfg = false;
+}
+
+void LevelQueue::fill(const LevelConfig & cfg)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// Different kind of level, the queued ones are stale
+	if (m_hasCfg == false || compatible(m_cfg, cfg) == false)
+	{
+		for (auto level : m_todo)
+			delete level;
+		for (auto level : m_ready)
+			delete level;
+		m_todo.clear();
+		m_ready.clear();
+		if (m_current)
+			m_current->cancel();
+
+		m_nextSeed = cfg.seed + 1;
+	}
+	m_cfg = cfg;
+	m_hasCfg = true;
+
+	// Top up, the worker generates one level at a time
+	while (m_todo.size() + m_ready.size() + ((m_current && m_current->isCancelled() == false) ? 1 : 0) < m_depth)
+	{
+		LevelConfig next = m_cfg;
+		next.seed = m_nextSeed++;
+		m_todo.push_back(new Level(next));
+	}
+
+	if (m_todo.empty() == false)
+	{
+		if (m_thread.joinable() == false)
+			m_thread = std::thread(&LevelQueue::worker, this);
+
+		m_cvTodo.notify_one();
+	}
+}
+
+Level * LevelQueue::pop()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_ready.empty())
+		return nullptr;
+
+	Level * level = m_ready.front();
+	m_ready.pop_front();
+
+	return level;
+}
+
+void LevelQueue::setDepth(size_t depth)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_depth = depth;
+}
+
+bool LevelQueue::isPending() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_ready.empty() == false || m_todo.empty() == false || (m_current && m_current->isCancelled() == false);
+}
+
+size_t LevelQueue::getReady() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_ready.size();
+}
+
+void LevelQueue::worker()
+{
+	// Generation only has to finish before the round does, leave the cores to the game
+	if (SDL_SetThreadPriority(SDL_THREAD_PRIORITY_LOW) != 0)
+	{
+		mlibc_dbg("LevelQueue::worker(). Could not lower thread priority: %s", SDL_GetError());
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true)
+	{
+		m_cvTodo.wait(lock, [this]() { return m_running == false || m_todo.empty() == false; });
+		if (m_running == false)
+			return;
+
+		m_current = m_todo.front();
+		m_todo.pop_front();
+
+		// Generate outside the lock, level textures are preloaded so this only reads TextureManager
+		Level * level = m_current;
+		lock.unlock();
+		level->regen(level->getCfg().seed);
+		lock.lock();
+
+		m_current = nullptr;
+		if (level->isCancelled())
+		{
+			delete level;
+		}
+		else
+		{
+			mlibc_inf("LevelQueue::worker(). Level %u ready (%zu queued).", level->getCfg().seed, m_ready.size() + 1);
+			m_ready.push_back(level);
+		}
+	}
+}
+
+bool LevelQueue::compatible(const LevelConfig & a, const LevelConfig & b)
+{
+	return (
+		a.type == b.type &&
+		a.width == b.width &&
+		a.height == b.height &&
+		a.n_scale == b.n_scale &&
+		a.dirt_n == b.dirt_n &&
+		a.object_n == b.object_n &&
+		a.water_n == b.water_n &&
+		a.lava_n == b.lava_n
+	);
+}
\ No newline at end of file
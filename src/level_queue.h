@@ -0,0 +1,53 @@
+#ifndef LEVEL_QUEUE_H
+#define LEVEL_QUEUE_H
+
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include "level.h"
+
+// Pre-generates the next rounds' levels on a low priority background thread, one
+// at a time, while the current round runs. Popped levels are owned by the caller.
+class LevelQueue
+{
+public:
+	LevelQueue(
+		size_t depth = 1
+	);
+	~LevelQueue();
+
+	// Queue levels following cfg's seed until depth levels are ready or generating.
+	// A config that differs in anything but the seed drops the queued levels.
+	void fill(const LevelConfig & cfg);
+
+	// Next generated level, never waits. nullptr while none is ready.
+	Level * pop();
+
+	// Levels queued or generating, pop() returns one once it is done
+	bool isPending() const;
+
+	// Cancel + join the worker, drop all queued levels
+	void stop();
+
+	void setDepth(size_t depth);
+	size_t getReady() const;
+private:
+	void worker();
+	static bool compatible(const LevelConfig & a, const LevelConfig & b);
+
+	size_t m_depth;
+	LevelConfig m_cfg;						// template of the queued levels
+	bool m_hasCfg;
+	uint32_t m_nextSeed;
+	std::deque<Level *> m_todo;				// waiting for the worker
+	std::deque<Level *> m_ready;			// generated
+	Level * m_current;						// being generated
+	std::thread m_thread;
+	mutable std::mutex m_mutex;
+	std::condition_variable m_cvTodo;
+	bool m_running;
+};
+
+#endif // LEVEL_QUEUE_H
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <SDL2/SDL.h>
 #include "3rdparty/json.hpp"
 #include "game.h"
+#include "job_manager.h"
 
 using json = nlohmann::json;
 
@@ -13,6 +14,16 @@ int main(int argc, char * argv[])
 {
 	int return_code = 0;
 
+	// Job system micro-benchmark instead of the game
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::string(argv[i]) == "--bench-jobs")
+		{
+			JobManager::benchmark();
+			return 0;
+		}
+	}
+
 	// Bootstrap game
 	try
 	{
@@ -36,9 +47,15 @@ int main(int argc, char * argv[])
 		cfg.win_scale = cfg_json["window"]["scale"].get<int>();
 		cfg.win_fullscreen = cfg_json["window"]["fullscreen"].get<bool>();
 		cfg.gfx_framerate = cfg_json["graphics"]["framerate"].get<float>();
+		cfg.gfx_threads = cfg_json["graphics"]["threads"].get<int>();
+		cfg.gfx_vsync = cfg_json["graphics"]["vsync"].get<bool>();
 		cfg.sfx_music_vol = cfg_json["audio"]["music_vol"].get<int>();
 		cfg.sfx_audio_vol = cfg_json["audio"]["audio_vol"].get<int>();
 		cfg.phy_tickrate = cfg_json["physics"]["tickrate"].get<float>();
+		cfg.phy_threaded = cfg_json["physics"]["threaded"].get<bool>();
+		cfg.phy_fluid_rate = cfg_json["physics"]["fluid_rate"].get<float>();
+		cfg.phy_tick_budget = cfg_json["physics"]["tick_budget"].get<float>();
+		cfg.lvl_queue_depth = cfg_json["level"]["queue_depth"].get<int>();
 		cfg.n_players = 2;
 
 		// Setup player controller bindings
@@ -46,25 +63,25 @@ int main(int argc, char * argv[])
 
 		// Player 1
 		std::map<int, std::string> p1;
-		p1[SDLK_LEFT] = "left";
-		p1[SDLK_RIGHT] = "right";
-		p1[SDLK_UP] = "up";
-		p1[SDLK_DOWN] = "down";
-		p1[SDLK_RCTRL] = "jump";
-		p1[SDLK_RETURN] = "fire";
-		p1[SDLK_BACKSPACE] = "reload";
-		p1[SDLK_RSHIFT] = "change";
+		p1[SDL_SCANCODE_LEFT] = "left";
+		p1[SDL_SCANCODE_RIGHT] = "right";
+		p1[SDL_SCANCODE_UP] = "up";
+		p1[SDL_SCANCODE_DOWN] = "down";
+		p1[SDL_SCANCODE_RCTRL] = "jump";
+		p1[SDL_SCANCODE_RETURN] = "fire";
+		p1[SDL_SCANCODE_BACKSPACE] = "reload";
+		p1[SDL_SCANCODE_RSHIFT] = "change";
 
 		// Player 2
 		std::map<int, std::string> p2;
-		p2[SDLK_a] = "left";
-		p2[SDLK_d] = "right";
-		p2[SDLK_w] = "up";
-		p2[SDLK_s] = "down";
-		p2[SDLK_SPACE] = "jump";
-		p2[SDLK_f] = "fire";
-		p2[SDLK_r] = "reload";
-		p2[SDLK_y] = "change";
+		p2[SDL_SCANCODE_A] = "left";
+		p2[SDL_SCANCODE_D] = "right";
+		p2[SDL_SCANCODE_W] = "up";
+		p2[SDL_SCANCODE_S] = "down";
+		p2[SDL_SCANCODE_SPACE] = "jump";
+		p2[SDL_SCANCODE_F] = "fire";
+		p2[SDL_SCANCODE_R] = "reload";
+		p2[SDL_SCANCODE_Y] = "change";
 
 		cfg.c_players.push_back(p1);
 		cfg.c_players.push_back(p2);
@@ -2,6 +2,7 @@
 #include <SDL2/SDL.h>
 #include "3rdparty/mlibc_log.h"
 #include "display_manager.h"
+#include "render_queue.h"
 #include "input_manager.h"
 #include "texture_manager.h"
 #include "audio_manager.h"
@@ -17,7 +18,10 @@ MenuItem::MenuItem(
 	m_text(text),
 	m_type(type),
 	m_value(value),
-	m_action(action)
+	m_action(action),
+	m_valueCached(false),
+	m_valueRaw(0.0),
+	m_valueText()
 {
 	mlibc_inf("MenuItem::MenuItem(%s).", m_text.c_str());
 }
@@ -37,6 +41,50 @@ MenuItemVal & MenuItem::getValue()
 	return m_value;
 }
 
+const std::string & MenuItem::getValueText()
+{
+	// Only numeric items have a value to show
+	if (m_type != MI_NUMERIC)
+	{
+		m_valueText.clear();
+		return m_valueText;
+	}
+
+	// Read the current value
+	double raw = 0.0;
+	switch (m_value.type)
+	{
+		case MIV_BOOL: raw = *reinterpret_cast<bool *>(m_value.value); break;
+		case MIV_UINT8: raw = *reinterpret_cast<uint8_t *>(m_value.value); break;
+		case MIV_UINT32: raw = *reinterpret_cast<uint32_t *>(m_value.value); break;
+		case MIV_INT8: raw = *reinterpret_cast<int8_t *>(m_value.value); break;
+		case MIV_INT32: raw = *reinterpret_cast<int32_t *>(m_value.value); break;
+		case MIV_FLOAT: raw = *reinterpret_cast<float *>(m_value.value); break;
+		case MIV_DOUBLE: raw = *reinterpret_cast<double *>(m_value.value); break;
+	}
+
+	// Re-format only when the value changed
+	if (m_valueCached == false || raw != m_valueRaw)
+	{
+		switch (m_value.type)
+		{
+			case MIV_BOOL: m_valueText = std::to_string(*reinterpret_cast<bool *>(m_value.value)); break;
+			case MIV_UINT8: m_valueText = std::to_string(*reinterpret_cast<uint8_t *>(m_value.value)); break;
+			case MIV_UINT32: m_valueText = std::to_string(*reinterpret_cast<uint32_t *>(m_value.value)); break;
+			case MIV_INT8: m_valueText = std::to_string(*reinterpret_cast<int8_t *>(m_value.value)); break;
+			case MIV_INT32: m_valueText = std::to_string(*reinterpret_cast<int32_t *>(m_value.value)); break;
+			case MIV_FLOAT: m_valueText = std::to_string(*reinterpret_cast<float *>(m_value.value)); break;
+			case MIV_DOUBLE: m_valueText = std::to_string(*reinterpret_cast<double *>(m_value.value)); break;
+			default: m_valueText.clear(); break;
+		}
+
+		m_valueCached = true;
+		m_valueRaw = raw;
+	}
+
+	return m_valueText;
+}
+
 std::function<void()> MenuItem::getAction() const
 {
 	return m_action;
@@ -49,7 +97,8 @@ Menu::Menu(
 	m_child(nullptr),
 	m_title(title),
 	m_items(),
-	m_active_item(0)
+	m_active_item(0),
+	m_hud()
 {
 	mlibc_inf("Menu::Menu(%s).", m_title.c_str());
 }
@@ -115,7 +164,7 @@ void Menu::render()
 	int m_y = m_sh / 2;
 
 	// Render menu background
-	DisplayManager::set_rect(m_x, m_y, m_w, m_h, 0, 0, 0, 160, true);
+	RenderQueue::rect(RenderQueue::RL_GUI, m_x, m_y, m_w, m_h, 0, 0, 0, 160, true);
 
 	// Calculate menu item dimensions
 	int mi_w = m_w - (m_w / 4);
@@ -129,7 +178,7 @@ void Menu::render()
 	int mif_h = mif_w;
 	int mif_x = mi_x + mi_x / 3 + mi_x / 2; // TODO; This is fucked up. Add support for centering text!
 	int mif_y = m_y + mif_h;
-	DisplayManager::set_text(mif_x, mif_y, mif_w, mif_h, m_title, 255, 255, 255, font);
+	m_hud.set_text(0, mif_x, mif_y, mif_w, mif_h, m_title, 255, 255, 255, font);
 
 	// Render menu items (only MAX_VISIBLE_ITEMS at a time)
 	const size_t items_start = (m_active_item < MAX_VISIBLE_ITEMS) ? 0 : (m_active_item - MAX_VISIBLE_ITEMS + 1);
@@ -143,35 +192,22 @@ void Menu::render()
 
 		// Only highlight current selected item
 		if (i == m_active_item)
-			DisplayManager::set_rect(mi_x, mi_y_, mi_w, mi_h, 128, 128, 128, 128, true);
+			RenderQueue::rect(RenderQueue::RL_GUI, mi_x, mi_y_, mi_w, mi_h, 128, 128, 128, 128, true);
 
 		// Calculate font dimensions
 		mif_x = mi_x;
 		mif_y = mi_y_ + mif_h / 2;
 
-		// Get value as string
-		std::string val_str;
-		switch (item->getType())
-		{
-			case MI_NUMERIC:
-			{
-				switch (item->getValue().type)
-				{
-					case MIV_BOOL: val_str = std::to_string(*reinterpret_cast<bool *>(item->getValue().value)); break;
-					case MIV_UINT8: val_str = std::to_string(*reinterpret_cast<uint8_t *>(item->getValue().value)); break;
-					case MIV_UINT32: val_str = std::to_string(*reinterpret_cast<uint32_t *>(item->getValue().value)); break;
-					case MIV_INT8: val_str = std::to_string(*reinterpret_cast<int8_t *>(item->getValue().value)); break;
-					case MIV_INT32: val_str = std::to_string(*reinterpret_cast<int32_t *>(item->getValue().value)); break;
-					case MIV_FLOAT: val_str = std::to_string(*reinterpret_cast<float *>(item->getValue().value)); break;
-					case MIV_DOUBLE: val_str = std::to_string(*reinterpret_cast<double *>(item->getValue().value)); break;
-				}
-			} break;
-		}
+		// Get value as string (cached until the value changes)
+		const std::string & val_str = item->getValueText();
 
 		// Render text + value
 		std::string text = (val_str.size() == 0) ? item->getText() : item->getText() + ":" + val_str;
-		DisplayManager::set_text(mif_x, mif_y, mif_w, mif_h, text, 255, 255, 255, font);
+		m_hud.set_text(1 + (i - items_start), mif_x, mif_y, mif_w, mif_h, text, 255, 255, 255, font);
 	}
+
+	// Composite cached title + item text
+	m_hud.render();
 }
 
 void Menu::update()
@@ -184,24 +220,21 @@ void Menu::update()
 	}
 
 	// Navigate the menu UP/DOWN
-	if (InputManager::KBOARD[SDLK_UP])
+	if (InputManager::KEYS_PRESSED[SDL_SCANCODE_UP])
 	{
 		AudioManager::play_audio("MOVEUP.SFX");
-		InputManager::KBOARD[SDLK_UP] = false;
 		m_active_item = (m_active_item > 0) ? m_active_item - 1 : m_active_item;
 	}
-	else if (InputManager::KBOARD[SDLK_DOWN])
+	else if (InputManager::KEYS_PRESSED[SDL_SCANCODE_DOWN])
 	{
 		AudioManager::play_audio("MOVEDOWN.SFX");
-		InputManager::KBOARD[SDLK_DOWN] = false;
 		m_active_item = (m_active_item < m_items.size() - 1) ? m_active_item + 1 : m_active_item;
 	}
 
 	// Navigate the menu backwards
-	if (InputManager::KBOARD[SDLK_ESCAPE])
+	if (InputManager::KEYS_PRESSED[SDL_SCANCODE_ESCAPE])
 	{
 		AudioManager::play_audio("SELECT.SFX");
-		InputManager::KBOARD[SDLK_DOWN] = false;
 
 		if (m_parent != nullptr)
 		{
@@ -211,11 +244,10 @@ void Menu::update()
 	}
 
 	// Change value (left & right)
-	if (InputManager::KBOARD[SDLK_LEFT] || InputManager::KBOARD[SDLK_RIGHT])
+	if (InputManager::KEYS_PRESSED[SDL_SCANCODE_LEFT] || InputManager::KEYS_PRESSED[SDL_SCANCODE_RIGHT])
 	{
-		int key = InputManager::KBOARD[SDLK_LEFT] ? SDLK_LEFT : SDLK_RIGHT;
-		AudioManager::play_audio((key == SDLK_LEFT) ? "MOVEDOWN.SFX" : "MOVEUP.SFX");
-		InputManager::KBOARD[key] = false;
+		int key = InputManager::KEYS_PRESSED[SDL_SCANCODE_LEFT] ? SDL_SCANCODE_LEFT : SDL_SCANCODE_RIGHT;
+		AudioManager::play_audio((key == SDL_SCANCODE_LEFT) ? "MOVEDOWN.SFX" : "MOVEUP.SFX");
 
 		// Get active item
 		MenuItem * item = m_items[m_active_item];
@@ -234,37 +266,37 @@ void Menu::update()
 				{
 					case MIV_BOOL:
 					{
-						*reinterpret_cast<bool *>(item->getValue().value) = (key == SDLK_LEFT) ? false : true;
+						*reinterpret_cast<bool *>(item->getValue().value) = (key == SDL_SCANCODE_LEFT) ? false : true;
 					} break;
 					case MIV_UINT8:
 					{
 						auto value = reinterpret_cast<uint8_t *>(item->getValue().value);
-						*value = (key == SDLK_LEFT) ? *value - v_inc : *value + v_inc;
+						*value = (key == SDL_SCANCODE_LEFT) ? *value - v_inc : *value + v_inc;
 					} break;
 					case MIV_UINT32:
 					{
 						auto value = reinterpret_cast<uint32_t *>(item->getValue().value);
-						*value = (key == SDLK_LEFT) ? *value - v_inc : *value + v_inc;
+						*value = (key == SDL_SCANCODE_LEFT) ? *value - v_inc : *value + v_inc;
 					} break;
 					case MIV_INT8:
 					{
 						auto value = reinterpret_cast<int8_t *>(item->getValue().value);
-						*value = (key == SDLK_LEFT) ? *value - v_inc : *value + v_inc;
+						*value = (key == SDL_SCANCODE_LEFT) ? *value - v_inc : *value + v_inc;
 					} break;
 					case MIV_INT32:
 					{
 						auto value = reinterpret_cast<int32_t *>(item->getValue().value);
-						*value = (key == SDLK_LEFT) ? *value - v_inc : *value + v_inc;
+						*value = (key == SDL_SCANCODE_LEFT) ? *value - v_inc : *value + v_inc;
 					} break;
 					case MIV_FLOAT:
 					{
 						auto value = reinterpret_cast<float *>(item->getValue().value);
-						*value = (key == SDLK_LEFT) ? *value - v_inc : *value + v_inc;
+						*value = (key == SDL_SCANCODE_LEFT) ? *value - v_inc : *value + v_inc;
 					} break;
 					case MIV_DOUBLE:
 					{
 						auto value = reinterpret_cast<double *>(item->getValue().value);
-						*value = (key == SDLK_LEFT) ? *value - v_inc : *value + v_inc;
+						*value = (key == SDL_SCANCODE_LEFT) ? *value - v_inc : *value + v_inc;
 					} break;
 				}
 			} break;
@@ -272,10 +304,9 @@ void Menu::update()
 	}
 
 	// Select menu item
-	if (InputManager::KBOARD[SDLK_RETURN])
+	if (InputManager::KEYS_PRESSED[SDL_SCANCODE_RETURN])
 	{
 		AudioManager::play_audio("SELECT.SFX");
-		InputManager::KBOARD[SDLK_RETURN] = false;
 
 		// Get selected item
 		MenuItem * item = m_items[m_active_item];
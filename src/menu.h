@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include "hud.h"
 
 enum MenuItem_t
 {
@@ -64,12 +65,16 @@ public:
 	const std::string & getText() const;
 	MenuItem_t getType() const;
 	MenuItemVal & getValue();
+	const std::string & getValueText();
 	std::function<void()> getAction() const;
 private:
 	std::string m_text;				// visible text
 	MenuItem_t m_type;				// item type (button, submenu, numeric, etc...)
 	MenuItemVal m_value;			// item value
 	std::function<void()> m_action;	// item action (function pointer)
+	bool m_valueCached;				// m_valueText is valid for m_valueRaw
+	double m_valueRaw;				// value the text was formatted from
+	std::string m_valueText;		// formatted value
 };
 
 class Menu
@@ -93,6 +98,7 @@ private:
 	std::string m_title;
 	std::vector<MenuItem *> m_items;
 	size_t m_active_item;
+	Hud m_hud;
 };
 
 #endif // MENU_H
\ No newline at end of file
@@ -16,7 +16,11 @@ MenuState::MenuState(
 	m_menu("MOLEZ"),
 	m_menu_game_cfg("GAME CFG"),
 	m_menu_level_cfg("LEVEL CFG"),
-	m_level(level)
+	m_level(level),
+	m_genLevel(nullptr),
+	m_genThread(),
+	m_genDone(false),
+	m_hud()
 {
 	// Define game cfg menu
 	m_menu_game_cfg.add_item(new MenuItem("WIN WIDTH", MI_NUMERIC, MenuItemVal(MIV_INT32, &m_game->getCfg().win_width, 1)));
@@ -42,27 +46,16 @@ MenuState::MenuState(
 
 	// Define game main menu
 	std::function<void()> action_newgame = [this]() {
+		// Wait for + take a pending level, PlayState loads textures which the generator must not race
+		finishRegen();
+
 		m_game->setState(new PlayState(m_game, m_level));
 	};
 	m_menu.add_item(new MenuItem("NEW GAME", MI_BUTTON, MenuItemVal(), action_newgame));
 	m_menu.add_item(new MenuItem("SERVER BROWSER", MI_EMPTY, MenuItemVal()));
 	std::function<void()> action_regen = [this]() {
-		// Re-generate level
-		m_level->regen((uint32_t)time(NULL));
-
-		// Init menu camera, translate to window center
-		int m_camera_x = DisplayManager::ACTIVE_WINDOW->width / 2;
-		int m_camera_y = -DisplayManager::ACTIVE_WINDOW->height / 2;
-		DisplayManager::Camera * m_camera = DisplayManager::load_camera("menu", 0, 0, 1);
-		m_camera->x = m_camera_x;
-		m_camera->y = m_camera_y;
-
-		// Init level camera, translate to level center
-		int l_camera_x = m_level->getCfg().width / 2;
-		int l_camera_y = -m_level->getCfg().height / 2;
-		DisplayManager::Camera * l_camera = DisplayManager::load_camera("level", 0, 0, 1);
-		l_camera->x = l_camera_x;
-		l_camera->y = l_camera_y;
+		// Re-generate level in the background, the current one keeps running until done
+		startRegen((uint32_t)time(NULL));
 	};
 	m_menu.add_item(new MenuItem("REGEN LEVEL", MI_BUTTON, MenuItemVal(), action_regen));
 	m_menu.add_item(new MenuItem("GAME CONFIG", MI_SUBMENU, MenuItemVal(MIV_EMPTY, &m_menu_game_cfg)));
@@ -73,17 +66,22 @@ MenuState::MenuState(
 	// Switch to menu music
 	AudioManager::play_music("MENU.MUS");
 
-	// Init level, init camera
-	action_regen();
+	// Init level (nothing to show meanwhile, so in place), init camera
+	m_level->regen((uint32_t)time(NULL));
+	resetCameras();
 }
 
 MenuState::~MenuState()
 {
-
+	cancelRegen();
 }
 
 void MenuState::update(float state, float t, float dt)
 {
+	// Swap in a completed background level
+	if (m_genDone)
+		finishRegen();
+
 	// Update level
 	if (m_level)
 		m_level->update(state, t, dt);
@@ -110,15 +108,91 @@ void MenuState::render(float state)
 	// Render menu
 	m_menu.render();
 
-	// Render debug info
-	DisplayManager::set_text(0, 0, 16, 16, "FPS:" + std::to_string(m_game->getCfg().gfx_framerate), 255, 0, 255, TextureManager::load_font("MOLEZ.JSON"));
-	DisplayManager::set_text(0, 16 * 1, 16, 16, "UPS:" + std::to_string(m_game->getCfg().phy_tickrate), 255, 0, 255, TextureManager::load_font("MOLEZ.JSON"));
-	DisplayManager::set_text(0, 16 * 2, 16, 16, "T:" + std::to_string(m_game->getPhysState().t), 255, 0, 255, TextureManager::load_font("MOLEZ.JSON"));
-	DisplayManager::set_text(0, 16 * 3, 16, 16, "DT:" + std::to_string(m_game->getPhysState().dt), 255, 0, 255, TextureManager::load_font("MOLEZ.JSON"));
-	DisplayManager::set_text(0, 16 * 4, 16, 16, "T_CURRENT:" + std::to_string(m_game->getPhysState().t_curr), 255, 0, 255, TextureManager::load_font("MOLEZ.JSON"));
-	DisplayManager::set_text(0, 16 * 5, 16, 16, "T_ACCUM:" + std::to_string(m_game->getPhysState().t_acc), 255, 0, 255, TextureManager::load_font("MOLEZ.JSON"));
-	DisplayManager::set_text(0, 16 * 6, 16, 16, "S_CURRENT:" + std::to_string(m_game->getPhysState().s_curr), 255, 0, 255, TextureManager::load_font("MOLEZ.JSON"));
-	DisplayManager::set_text(0, 16 * 7, 16, 16, "S_PREVIOUS:" + std::to_string(m_game->getPhysState().s_prev), 255, 0, 255, TextureManager::load_font("MOLEZ.JSON"));
-	DisplayManager::set_text(0, 16 * 8, 16, 16, "S_LERP:" + std::to_string(m_game->getPhysState().s_lerp), 255, 0, 255, TextureManager::load_font("MOLEZ.JSON"));
-	DisplayManager::set_text(0, 16 * 9, 16, 16, "ALPHA:" + std::to_string(m_game->getPhysState().alpha), 255, 0, 255, TextureManager::load_font("MOLEZ.JSON"));
+	// Render debug info, re-rasterised only when a value changes
+	TextureManager::Font * font = TextureManager::load_font("MOLEZ.JSON");
+	const PhysicsState phys = m_game->getPhysState();
+	const FrameStats frame = m_game->getFrameStats();
+	m_hud.set_value(0, 0, 0, 16, 16, "FPS:", static_cast<float>(frame.fps), 255, 0, 255, font);
+	m_hud.set_value(1, 0, 16 * 1, 16, 16, "UPS:", m_game->getCfg().phy_tickrate, 255, 0, 255, font);
+	m_hud.set_value(2, 0, 16 * 2, 16, 16, "T:", static_cast<float>(phys.t), 255, 0, 255, font);
+	m_hud.set_value(3, 0, 16 * 3, 16, 16, "DT:", static_cast<float>(phys.dt), 255, 0, 255, font);
+	m_hud.set_value(4, 0, 16 * 4, 16, 16, "T_CURRENT:", static_cast<float>(phys.t_curr), 255, 0, 255, font);
+	m_hud.set_value(5, 0, 16 * 5, 16, 16, "T_ACCUM:", static_cast<float>(phys.t_acc), 255, 0, 255, font);
+	m_hud.set_value(6, 0, 16 * 6, 16, 16, "S_CURRENT:", phys.s_curr, 255, 0, 255, font);
+	m_hud.set_value(7, 0, 16 * 7, 16, 16, "S_PREVIOUS:", phys.s_prev, 255, 0, 255, font);
+	m_hud.set_value(8, 0, 16 * 8, 16, 16, "S_LERP:", phys.s_lerp, 255, 0, 255, font);
+	m_hud.set_value(9, 0, 16 * 9, 16, 16, "ALPHA:", phys.alpha, 255, 0, 255, font);
+	m_hud.set_value(10, 0, 16 * 10, 16, 16, "JITTER MS:", static_cast<float>(frame.jitter * 1000.0), 255, 0, 255, font);
+	m_hud.set_value(11, 0, 16 * 11, 16, 16, "OVERRUNS:", static_cast<float>(phys.overruns), 255, 0, 255, font);
+
+	// Background generation progress
+	if (m_genLevel)
+		m_hud.set_value(12, 0, 16 * 12, 16, 16, "GENERATING %:", m_genLevel->getProgress() * 100.0f, 255, 255, 0, font);
+	else
+		m_hud.hide(12);
+
+	m_hud.render();
+}
+
+void MenuState::resetCameras()
+{
+	// Init menu camera, translate to window center
+	int m_camera_x = DisplayManager::ACTIVE_WINDOW->width / 2;
+	int m_camera_y = -DisplayManager::ACTIVE_WINDOW->height / 2;
+	DisplayManager::Camera * m_camera = DisplayManager::load_camera("menu", 0, 0, 1);
+	m_camera->x = m_camera_x;
+	m_camera->y = m_camera_y;
+
+	// Init level camera, translate to level center
+	int l_camera_x = m_level->getCfg().width / 2;
+	int l_camera_y = -m_level->getCfg().height / 2;
+	DisplayManager::Camera * l_camera = DisplayManager::load_camera("level", 0, 0, 1);
+	l_camera->x = l_camera_x;
+	l_camera->y = l_camera_y;
+}
+
+void MenuState::startRegen(uint32_t seed)
+{
+	// Drop a stale generation still in progress
+	cancelRegen();
+
+	// Generate from the current (menu edited) config into a fresh level
+	m_genLevel = new Level(m_level->getCfg());
+	m_genDone = false;
+
+	Level * level = m_genLevel;
+	std::atomic<bool> * done = &m_genDone;
+	m_genThread = std::thread([level, done, seed]() {
+		level->regen(seed);
+		*done = true;
+	});
+}
+
+void MenuState::finishRegen()
+{
+	if (m_genLevel == nullptr)
+		return;
+
+	if (m_genThread.joinable())
+		m_genThread.join();
+
+	// Swap contents so pointers to m_level (+ its config) stay valid
+	if (m_genLevel->isCancelled() == false)
+	{
+		m_level->swap(*m_genLevel);
+		resetCameras();
+	}
+
+	delete m_genLevel;
+	m_genLevel = nullptr;
+	m_genDone = false;
+}
+
+void MenuState::cancelRegen()
+{
+	if (m_genLevel == nullptr)
+		return;
+
+	m_genLevel->cancel();
+	finishRegen();
 }
\ No newline at end of file
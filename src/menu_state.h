@@ -1,8 +1,12 @@
 #ifndef MENU_STATE_H
 #define MENU_STATE_H
 
+#include <thread>
+#include <atomic>
+#include <cstdint>
 #include "game_state.h"
 #include "menu.h"
+#include "hud.h"
 
 class Level;
 
@@ -18,10 +22,19 @@ public:
 	virtual void update(float state, float t, float dt) override;
 	virtual void render(float state) override;
 private:
+	void resetCameras();
+	void startRegen(uint32_t seed);
+	void finishRegen();
+	void cancelRegen();
+
 	Menu m_menu;
 	Menu m_menu_game_cfg;
 	Menu m_menu_level_cfg;
 	Level * m_level;
+	Level * m_genLevel;						// level generating in the background, swapped into m_level when done
+	std::thread m_genThread;
+	std::atomic<bool> m_genDone;
+	Hud m_hud;
 };
 
 #endif // MENU_STATE_H
\ No newline at end of file
@@ -26,6 +26,22 @@ namespace Physics
 
 	};
 
+	// Previous + current tick position, interpolated by the renderer with PhysicsState::alpha
+	struct Transform
+	{
+		Math::vec2 prev;
+		Math::vec2 curr;
+
+		Transform(
+			Math::vec2 pos = Math::vec2()
+		) :
+			prev(pos),
+			curr(pos)
+		{
+
+		}
+	};
+
 }
 
 #endif // PHYSICS_H
\ No newline at end of file
@@ -9,16 +9,22 @@
 #include "texture_manager.h"
 #include "input_manager.h"
 #include "sprite.h"
-#include "entity.h"
-#include "player.h"
 
 PlayState::PlayState(
 	Game * const game,
-	Level * level
+	Level * level,
+	bool owns_level
 ) :
 	GameState(game),
 	m_level(level),
-	m_entities()
+	m_ownsLevel(owns_level),
+	m_nextRound(false),
+	m_world(game, level),
+	m_players(),
+	m_time(0.0f),
+	m_hud(),
+	m_scheduler(game->getCfg().phy_tickrate),
+	m_watchdog(game->getCfg().phy_tick_budget / game->getCfg().phy_tickrate)
 {
 	// Init gui camera, translate to window center
 	int g_camera_x = DisplayManager::ACTIVE_WINDOW->width / 2;
@@ -43,77 +49,121 @@ PlayState::PlayState(
 	AudioManager::play_audio("BEGIN.SFX");
 
 	// Get player count & spawn players
-	size_t n_players = m_game->getCfg().n_players;
+	const GameConfig & game_cfg = m_game->getCfg();
+	size_t n_players = game_cfg.n_players;
 	for (size_t i = 0; i < n_players; i++)
 	{
 		// Create props
 		EntityProps player_props{ E_PLAYER_OFFLINE, "player " + std::to_string(i), vec2(), 2.5f, ES_DEAD, 100.0f };
 
-		// Create player
-		Player * player_entity = new Player(m_game, m_level, player_props);
+		// Create player, controlled by controller i
+		uint8_t controller = static_cast<uint8_t>(i);
+		m_players.push_back(m_world.create(player_props, Sprite(Sprite::load_sheet("PLAYER.JSON")), controller));
 
-		// Set player controller
-		EntityCtrl player_ctrl = player_entity->getCtrl();
-
-		auto game_cfg = m_game->getCfg();
+		// Set player controller, default bindings unless configured
 		if (i + 1 <= game_cfg.c_players.size())
 		{
-			player_ctrl.bind_map = game_cfg.c_players[i];
+			m_world.bind(controller, game_cfg.c_players[i]);
+		}
+		else
+		{
+			m_world.bind(controller, {
+				{ SDL_SCANCODE_LEFT, "left" },
+				{ SDL_SCANCODE_RIGHT, "right" },
+				{ SDL_SCANCODE_UP, "up" },
+				{ SDL_SCANCODE_DOWN, "down" },
+				{ SDL_SCANCODE_RCTRL, "jump" },
+				{ SDL_SCANCODE_RETURN, "fire" },
+				{ SDL_SCANCODE_BACKSPACE, "reload" },
+				{ SDL_SCANCODE_RSHIFT, "change" }
+			});
 		}
-
-		player_entity->setCtrl(player_ctrl);
-
-		// Push to entity list
-		m_entities.push_back(player_entity);
 	}
+
+	// Schedule subsystems, each at its own rate. Tick stages are declared in frame
+	// order with the data they read + write, the scheduler's frame graph runs the
+	// ones that do not conflict concurrently.
+	const GameConfig & cfg = m_game->getCfg();
+	m_scheduler.add("input", cfg.phy_tickrate, FR_INPUT, FR_CONTROL, [this](float t, float dt) {
+		m_world.input();
+	});
+	m_scheduler.add("physics", cfg.phy_tickrate, FR_CONTROL | FR_TERRAIN, FR_ENTITIES | FR_PROJECTILES | FR_EDITS, [this](float t, float dt) {
+		m_world.tick(t, dt);
+	});
+	m_scheduler.add("terrain edits", cfg.phy_tickrate, FR_EDITS, FR_TERRAIN | FR_AUDIO | FR_EDITS, [this](float t, float dt) {
+		m_world.edit();
+	}, FN_MAIN);
+	size_t fluids = m_scheduler.add("fluids", cfg.phy_fluid_rate, FR_TERRAIN, FR_TERRAIN, [this](float t, float dt) {
+		if (m_level)
+		{
+			m_level->update(m_game->getPhysState().s_curr, t, dt);
+		}
+	});
+	m_scheduler.add("animation", RATE_FRAME, [this](float t, float dt) {
+		m_world.animate(t, dt);
+	});
+
+	// Degradation policies when ticks run over budget, cheapest visual loss first
+	float fluid_rate = cfg.phy_fluid_rate;
+	m_watchdog.add("half fluid rate",
+		[this, fluids, fluid_rate]() { m_scheduler.setRate(fluids, fluid_rate * 0.5f); },
+		[this, fluids, fluid_rate]() { m_scheduler.setRate(fluids, fluid_rate); }
+	);
+	m_watchdog.add("half projectiles",
+		[this]() { m_world.getProjectiles().setLimit(PROJECTILE_CAPACITY / 2); },
+		[this]() { m_world.getProjectiles().setLimit(0); }
+	);
+	m_watchdog.add("quarter projectiles",
+		[this]() { m_world.getProjectiles().setLimit(PROJECTILE_CAPACITY / 4); },
+		[this]() { m_world.getProjectiles().setLimit(PROJECTILE_CAPACITY / 2); }
+	);
+
+	// Start generating the next round's level(s) while this one runs
+	m_game->getLevelQueue().fill(m_level->getCfg());
 }
 
 PlayState::~PlayState()
 {
-	for (auto e : m_entities)
-	{
-		delete e;
-	}
+	if (m_ownsLevel)
+		delete m_level;
 }
 
 void PlayState::update(float state, float t, float dt)
 {
 	// Handle input
-	if (InputManager::KBOARD[SDLK_1])
+	if (InputManager::KEYS_PRESSED[SDL_SCANCODE_1])
 	{
-		Entity * player = getEntityByName("player 0");
-
-		if (player)
+		if (m_players.size() > 0 && m_world.valid(m_players[0]))
 		{
-			player->setState(ES_DEAD);
+			m_world.setState(m_players[0], ES_DEAD);
 		}
-
-		InputManager::KBOARD[SDLK_1] = false;
 	}
-	if (InputManager::KBOARD[SDLK_2])
+	if (InputManager::KEYS_PRESSED[SDL_SCANCODE_2])
 	{
-		Entity * player = getEntityByName("player 1");
-
-		if (player)
+		if (m_players.size() > 1 && m_world.valid(m_players[1]))
 		{
-			player->setState(ES_DEAD);
+			m_world.setState(m_players[1], ES_DEAD);
 		}
-
-		InputManager::KBOARD[SDLK_2] = false;
 	}
 
-	// Update level
-	if (m_level)
+	// Dump stage timings
+	if (InputManager::KEYS_PRESSED[SDL_SCANCODE_F9])
 	{
-		m_level->update(state, t, dt);
+		m_scheduler.getGraph().dump();
+		m_game->getFrameGraph().dump();
 	}
 
-	// Update entities
-	for (auto e : m_entities)
+	// Next round, this one keeps running until its level is ready
+	if (InputManager::KEYS_PRESSED[SDL_SCANCODE_N] || m_nextRound)
 	{
-		e->update(t, dt);
+		if (nextRound())
+			return;
 	}
 
+	// Update level + entities at their scheduled rates, degrade them when over budget
+	m_scheduler.tick(t);
+	m_watchdog.update(m_scheduler);
+
 	// Update gui
 	//m_menu.update();
 
@@ -123,6 +173,9 @@ void PlayState::update(float state, float t, float dt)
 
 void PlayState::render(float state)
 {
+	// Per-frame subsystems (sprite animation)
+	m_scheduler.frame(static_cast<float>(m_game->getPhysState().t));
+
 	// Render level
 	if (m_level)
 	{
@@ -134,35 +187,69 @@ void PlayState::render(float state)
 	}
 
 	// Render entities
-	for (auto e : m_entities)
-	{
-		e->render();
-	}
+	m_world.render();
 
 	// Switch to gui camera
 	DisplayManager::activate_camera("gui");
 
-	auto player1 = getEntityByName("player 0");
+	if (m_players.empty() == false && m_world.valid(m_players[0]))
+	{
+		TextureManager::Font * font = TextureManager::load_font("MOLEZ.JSON");
+		m_hud.set_value(0, 0, 0, 16, 16, "PLAYER X: ", m_world.getPVA(m_players[0]).pos.x, 255, 0, 255, font);
+		m_hud.set_value(1, 0, 16 * 1, 16, 16, "PLAYER Y: ", m_world.getPVA(m_players[0]).pos.y, 255, 0, 255, font);
+	}
+	else
+	{
+		m_hud.hide(0);
+		m_hud.hide(1);
+	}
+
+	// Entity allocations since the last frame, heap growths should stay at zero
+	const WorldAllocStats & allocs = m_world.getAllocStats();
+	TextureManager::Font * font = TextureManager::load_font("MOLEZ.JSON");
+	m_hud.set_value(2, 0, 16 * 2, 16, 16, "ENTITY ALLOCS: ", static_cast<float>(allocs.created), 255, 0, 255, font);
+	m_hud.set_value(3, 0, 16 * 3, 16, 16, "ENTITY HEAP: ", static_cast<float>(allocs.heap), 255, 0, 255, font);
+	m_world.resetAllocStats();
 
-	if (player1)
+	if (m_nextRound)
 	{
-		DisplayManager::set_text(0, 0, 16, 16, "PLAYER X: " + std::to_string(player1->getPVA().pos.x), 255, 0, 255, TextureManager::load_font("MOLEZ.JSON"));
-		DisplayManager::set_text(0, 16 * 1, 16, 16, "PLAYER Y: " + std::to_string(player1->getPVA().pos.y), 255, 0, 255, TextureManager::load_font("MOLEZ.JSON"));
+		m_hud.set_text(4, 0, 16 * 4, 16, 16, "LOADING NEXT ROUND...", 255, 0, 255, font);
+	}
+	else
+	{
+		m_hud.hide(4);
 	}
 
+	// Composite cached HUD text
+	m_hud.render();
+
 	// Render gui
 	//m_menu.render();
 }
 
-Entity * PlayState::getEntityByName(const std::string & name)
+World & PlayState::getWorld()
 {
-	for (auto e : m_entities)
+	return m_world;
+}
+
+bool PlayState::nextRound()
+{
+	// Take a pre-generated level, keep playing while it is still generating
+	LevelQueue & queue = m_game->getLevelQueue();
+	Level * level = queue.pop();
+	if (level == nullptr)
 	{
-		if (e->getProps().name == name)
+		if (queue.isPending())
 		{
-			return e;
+			m_nextRound = true;
+			return false;
 		}
+
+		// Nothing queued (queue depth 0), generate in place
+		level = new Level(m_level->getCfg());
+		level->regen(m_level->getCfg().seed + 1);
 	}
 
-	return nullptr;
+	m_game->setState(new PlayState(m_game, level, true));
+	return true;
 }
\ No newline at end of file
@@ -5,30 +5,42 @@
 #include "math.h"
 #include "game_state.h"
 #include "menu.h"
+#include "hud.h"
+#include "scheduler.h"
+#include "watchdog.h"
+#include "world.h"
 
 using namespace Math;
 
 class Level;
 class Sprite;
-class Entity;
 
 class PlayState : public GameState
 {
 public:
 	PlayState(
 		Game * const game,
-		Level * level
+		Level * level,
+		bool owns_level = false
 	);
 	virtual ~PlayState() override;
 
 	virtual void update(float state, float t, float dt) override;
 	virtual void render(float state) override;
 
-	Entity * getEntityByName(const std::string & name);
+	World & getWorld();
 private:
+	bool nextRound();
+
 	Level * m_level;
-	std::vector<Entity *> m_entities;
+	bool m_ownsLevel;						// level came from the LevelQueue, deleted with the state
+	bool m_nextRound;						// waiting for the next round's level to finish generating
+	World m_world;
+	std::vector<EntityHandle> m_players;		// player entity per controller
 	float m_time;
+	Hud m_hud;
+	Scheduler m_scheduler;
+	Watchdog m_watchdog;
 };
 
 #endif // PLAY_STATE_H
\ No newline at end of file
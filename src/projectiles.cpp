@@ -0,0 +1,210 @@
+#include "projectiles.h"
+#include "render_queue.h"
+
+Projectiles::Projectiles(size_t capacity) :
+	m_pos(),
+	m_prev(),
+	m_vel(),
+	m_gravity(),
+	m_life(),
+	m_crater(),
+	m_damage(),
+	m_color(),
+	m_owner(),
+	m_hits(),
+	m_craters(),
+	m_limit(0)
+{
+	m_pos.reserve(capacity);
+	m_prev.reserve(capacity);
+	m_vel.reserve(capacity);
+	m_gravity.reserve(capacity);
+	m_life.reserve(capacity);
+	m_crater.reserve(capacity);
+	m_damage.reserve(capacity);
+	m_color.reserve(capacity);
+	m_owner.reserve(capacity);
+}
+
+Projectiles::~Projectiles()
+{
+
+}
+
+void Projectiles::spawn(const ProjectileDesc & desc, const Math::vec2 & pos, const Math::vec2 & dir, EntityHandle owner)
+{
+	if (m_limit > 0 && size() >= m_limit)
+		return;
+
+	m_pos.push_back(pos);
+	m_prev.push_back(pos);
+	m_vel.push_back(dir * desc.speed);
+	m_gravity.push_back(desc.gravity);
+	m_life.push_back(desc.life);
+	m_crater.push_back(desc.crater);
+	m_damage.push_back(desc.damage);
+	m_color.push_back((desc.r << 16) | (desc.g << 8) | desc.b);
+	m_owner.push_back(owner);
+}
+
+void Projectiles::clear()
+{
+	m_pos.clear();
+	m_prev.clear();
+	m_vel.clear();
+	m_gravity.clear();
+	m_life.clear();
+	m_crater.clear();
+	m_damage.clear();
+	m_color.clear();
+	m_owner.clear();
+	m_hits.clear();
+	m_craters.clear();
+}
+
+void Projectiles::setLimit(size_t limit)
+{
+	m_limit = limit;
+}
+
+void Projectiles::tick(Level * level, SpatialGrid * grid, float dt)
+{
+	m_hits.clear();
+
+	// Integrate (semi-implicit euler)
+	size_t n = size();
+	for (size_t i = 0; i < n; i++)
+	{
+		m_prev[i] = m_pos[i];
+		m_vel[i] += m_gravity[i] * dt;
+		m_pos[i] += m_vel[i] * dt;
+		m_life[i] -= dt;
+	}
+
+	if (level == nullptr)
+		return;
+
+	// Sweep the tick's motion, iterate backwards so kill() can swap in the last projectile
+	int32_t w = level->getCfg().width;
+	int32_t h = level->getCfg().height;
+	for (size_t i = n; i-- > 0;)
+	{
+		ProjectileHit hit;
+		hit.owner = m_owner[i];
+		hit.target = EntityHandle();
+		hit.crater = 0;
+		hit.damage = m_damage[i];
+
+		// Entities first, the terrain only needs sweeping up to the nearest one
+		Math::vec2 to = m_pos[i];
+		float t_entity;
+		if (grid && grid->querySegment(m_prev[i], m_pos[i], hit.target, t_entity, m_owner[i]))
+		{
+			to = m_prev[i] + (m_pos[i] - m_prev[i]) * t_entity;
+		}
+
+		if (level->raycast(m_prev[i], to, hit.hit))
+		{
+			hit.target = EntityHandle();
+			hit.crater = m_crater[i];
+			m_hits.push_back(hit);
+
+			if (hit.crater > 0)
+			{
+				m_craters.push_back(Crater{ hit.hit.x, hit.hit.y, hit.crater, M_VOID, T_AIR });
+			}
+
+			kill(i);
+			continue;
+		}
+
+		if (hit.target.isNull() == false)
+		{
+			hit.hit.x = static_cast<int32_t>(to.x);
+			hit.hit.y = static_cast<int32_t>(to.y);
+			hit.hit.pos = to;
+			hit.hit.normal = (m_prev[i] - m_pos[i]).normalize();
+			m_hits.push_back(hit);
+
+			kill(i);
+			continue;
+		}
+
+		// Expired or left the level
+		const Math::vec2 & p = m_pos[i];
+		if (m_life[i] <= 0.0f || p.x < 0.0f || p.x >= w || p.y < 0.0f || p.y >= h)
+		{
+			kill(i);
+		}
+	}
+}
+
+void Projectiles::carve(Level * level)
+{
+	// Every crater since the last carve in one pass
+	if (level && m_craters.empty() == false)
+	{
+		level->alter(m_craters);
+	}
+
+	m_craters.clear();
+}
+
+void Projectiles::render()
+{
+	for (size_t i = 0; i < size(); i++)
+	{
+		uint32_t c = m_color[i];
+
+		RenderQueue::rect_lerp(
+			RenderQueue::RL_ENTITY,
+			static_cast<int>(m_prev[i].x),
+			static_cast<int>(m_prev[i].y),
+			static_cast<int>(m_pos[i].x),
+			static_cast<int>(m_pos[i].y),
+			2,
+			2,
+			static_cast<uint8_t>(c >> 16),
+			static_cast<uint8_t>(c >> 8),
+			static_cast<uint8_t>(c)
+		);
+	}
+}
+
+size_t Projectiles::size() const
+{
+	return m_pos.size();
+}
+
+const std::vector<ProjectileHit> & Projectiles::getHits() const
+{
+	return m_hits;
+}
+
+void Projectiles::kill(size_t i)
+{
+	// Keep arrays dense, move the last projectile into the hole
+	size_t last = size() - 1;
+	if (i != last)
+	{
+		m_pos[i] = m_pos[last];
+		m_prev[i] = m_prev[last];
+		m_vel[i] = m_vel[last];
+		m_gravity[i] = m_gravity[last];
+		m_life[i] = m_life[last];
+		m_crater[i] = m_crater[last];
+		m_damage[i] = m_damage[last];
+		m_color[i] = m_color[last];
+		m_owner[i] = m_owner[last];
+	}
+
+	m_pos.pop_back();
+	m_prev.pop_back();
+	m_vel.pop_back();
+	m_gravity.pop_back();
+	m_life.pop_back();
+	m_crater.pop_back();
+	m_damage.pop_back();
+	m_color.pop_back();
+	m_owner.pop_back();
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#ifndef PROJECTILES_H
+#define PROJECTILES_H
+
+#include <vector>
+#include <cstdint>
+#include "math.h"
+#include "level.h"
+#include "entity_handle.h"
+#include "spatial_grid.h"
+
+// Projectiles reserved up front, spawning past this grows the arrays
+#define PROJECTILE_CAPACITY 4096
+
+struct ProjectileDesc
+{
+	float speed;							// muzzle speed, pixels per second
+	float life;								// seconds before expiring in the air
+	Math::vec2 gravity;						// acceleration, pixels per second^2
+	uint8_t crater;							// crater radius on terrain hit, 0 = none
+	float damage;							// health taken on a direct hit, splash damage within 2x crater radius
+	uint8_t r, g, b;						// render color
+};
+
+struct ProjectileHit
+{
+	LevelHit hit;							// hit pixel, point + normal
+	EntityHandle owner;						// entity that fired it
+	EntityHandle target;					// entity hit, null on a terrain hit
+	uint8_t crater;							// crater radius, terrain hits only
+	float damage;
+};
+
+// Projectile store, kept as parallel arrays so the integrate + sweep loop
+// only touches what it needs. Each tick's motion is swept against the entity
+// grid + the terrain, nearest hit wins. Terrain hits are collected during the tick
+// and carved into the level as one crater batch by carve().
+class Projectiles
+{
+public:
+	Projectiles(size_t capacity = PROJECTILE_CAPACITY);
+	~Projectiles();
+
+	void spawn(const ProjectileDesc & desc, const Math::vec2 & pos, const Math::vec2 & dir, EntityHandle owner);
+	void clear();
+	void setLimit(size_t limit);			// live projectiles, spawns past it are dropped, 0 = none
+
+	void tick(Level * level, SpatialGrid * grid, float dt);
+	void carve(Level * level);				// craters collected since the last carve
+	void render();
+
+	size_t size() const;
+	const std::vector<ProjectileHit> & getHits() const;	// hits of the last tick
+private:
+	void kill(size_t i);
+
+	// Hot, touched every tick
+	std::vector<Math::vec2> m_pos;
+	std::vector<Math::vec2> m_prev;			// position before the last tick, for sweeps + render interpolation
+	std::vector<Math::vec2> m_vel;
+	std::vector<Math::vec2> m_gravity;
+	std::vector<float> m_life;
+
+	// Cold, only touched on hit + render
+	std::vector<uint8_t> m_crater;
+	std::vector<float> m_damage;
+	std::vector<uint32_t> m_color;			// 0x00RRGGBB
+	std::vector<EntityHandle> m_owner;
+
+	std::vector<ProjectileHit> m_hits;
+	std::vector<Crater> m_craters;
+	size_t m_limit;
+};
+
+#endif // PROJECTILES_H
\ No newline at end of file
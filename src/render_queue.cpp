@@ -0,0 +1,280 @@
+#include "render_queue.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include "display_manager.h"
+#include "sprite.h"
+
+// Triple buffer slot flag, set while the ready slot holds an unread frame
+#define SLOT_FRESH 0x4
+#define SLOT_INDEX 0x3
+
+namespace RenderQueue
+{
+
+	// Triple buffer; the recorder owns WRITE, the renderer owns READ, READY is exchanged between them
+	static Frame FRAMES[3];
+	static int WRITE = 0;
+	static int READ = 1;
+	static std::atomic<int> READY(2);
+	static std::atomic<uint64_t> ACQUIRED(0);
+	static uint64_t SEQUENCE = 0;
+	static float ALPHA = 1.0f;
+
+	// Start a command with the active camera copied in
+	static Command make_cmd(Command_t type, Layer_t layer, int x, int y, int w, int h)
+	{
+		Command cmd = Command();
+
+		cmd.type = type;
+		cmd.layer = layer;
+		cmd.camera = (DisplayManager::ACTIVE_CAMERA != nullptr);
+		cmd.cam_x = (cmd.camera) ? DisplayManager::ACTIVE_CAMERA->x : 0;
+		cmd.cam_y = (cmd.camera) ? DisplayManager::ACTIVE_CAMERA->y : 0;
+		cmd.x = x;
+		cmd.y = y;
+		cmd.w = w;
+		cmd.h = h;
+		cmd.prev_x = x;
+		cmd.prev_y = y;
+		cmd.alpha = -1;
+
+		return cmd;
+	}
+
+	// Is any part of the command visible through its camera (either end of its movement)
+	static bool visible(const Command & cmd)
+	{
+		const DisplayManager::Window * win = DisplayManager::ACTIVE_WINDOW;
+		if (win == nullptr || cmd.w <= 0 || cmd.h <= 0)
+			return false;
+
+		int x0 = std::min(cmd.x, cmd.prev_x);
+		int y0 = std::min(cmd.y, cmd.prev_y);
+		int x1 = std::max(cmd.x, cmd.prev_x) + cmd.w;
+		int y1 = std::max(cmd.y, cmd.prev_y) + cmd.h;
+		if (cmd.camera)
+		{
+			int tx = win->width / 2 - cmd.cam_x;
+			int ty = win->height / 2 + cmd.cam_y;
+			x0 += tx;
+			x1 += tx;
+			y0 += ty;
+			y1 += ty;
+		}
+
+		return (x0 < win->width && y0 < win->height && x1 > 0 && y1 > 0);
+	}
+
+	static bool record(const Command & cmd)
+	{
+		Frame & frame = FRAMES[WRITE];
+		frame.stats.submitted++;
+
+		if (visible(cmd) == false)
+		{
+			frame.stats.culled++;
+			return false;
+		}
+
+		frame.cmds.push_back(cmd);
+		return true;
+	}
+
+	static void run(const Frame & frame, float alpha)
+	{
+		// Commands carry their own camera, ACTIVE_CAMERA stays with the recording thread
+		DisplayManager::Camera camera = DisplayManager::Camera();
+
+		for (const Command & cmd : frame.cmds)
+		{
+			camera.x = cmd.cam_x;
+			camera.y = cmd.cam_y;
+			DisplayManager::override_camera(true, (cmd.camera) ? &camera : nullptr);
+
+			int x = cmd.prev_x + static_cast<int>(static_cast<float>(cmd.x - cmd.prev_x) * alpha + 0.5f);
+			int y = cmd.prev_y + static_cast<int>(static_cast<float>(cmd.y - cmd.prev_y) * alpha + 0.5f);
+
+			switch (cmd.type)
+			{
+				case RC_CLEAR: DisplayManager::clear(cmd.argb); break;
+				case RC_LEVEL: DisplayManager::set_image(x, y, cmd.w, cmd.h, frame.level.pixels.data(), cmd.flag); break;
+				case RC_SPRITE: DisplayManager::set_sprite(x, y, cmd.frame, cmd.alpha); break;
+				case RC_RECT: DisplayManager::set_rect(x, y, cmd.w, cmd.h, cmd.r, cmd.g, cmd.b, cmd.a, cmd.flag); break;
+				case RC_TEXT: DisplayManager::set_mask(x, y, cmd.w, cmd.h, &frame.bytes[cmd.offset], cmd.r, cmd.g, cmd.b); break;
+			}
+		}
+
+		// Rasterise while the local camera copy is still alive
+		DisplayManager::flush();
+		DisplayManager::override_camera(false);
+	}
+
+	void begin()
+	{
+		Frame & frame = FRAMES[WRITE];
+
+		frame.cmds.clear();
+		frame.bytes.clear();
+		frame.stats = Stats();
+	}
+
+	void clear(int32_t argb)
+	{
+		// Whole-fbo fill, never culled
+		Command cmd = make_cmd(RC_CLEAR, RL_BACKGROUND, 0, 0, 0, 0);
+		cmd.camera = false;
+		cmd.argb = argb;
+
+		FRAMES[WRITE].stats.submitted++;
+		FRAMES[WRITE].cmds.push_back(cmd);
+	}
+
+	void level(
+		Layer_t layer,
+		int x,
+		int y,
+		int w,
+		int h,
+		const int32_t * pixels,
+		bool opaque,
+		const uint32_t * row_gens,
+		uint32_t gen
+	)
+	{
+		Command cmd = make_cmd(RC_LEVEL, layer, x, y, w, h);
+		cmd.flag = opaque;
+		if (record(cmd) == false)
+			return;
+
+		// Bring the frame's own copy up to date, everything on a source or size change
+		Frame & frame = FRAMES[WRITE];
+		LevelCopy & copy = frame.level;
+		bool full = (row_gens == nullptr || copy.src != pixels || copy.w != w || copy.h != h);
+
+		copy.pixels.resize(static_cast<size_t>(w * h));
+		for (int i = 0; i < h; i++)
+		{
+			if (full || row_gens[i] > copy.gen)
+			{
+				std::memcpy(&copy.pixels[i * w], &pixels[i * w], w * sizeof(int32_t));
+				frame.stats.level_rows++;
+			}
+		}
+
+		copy.src = pixels;
+		copy.w = w;
+		copy.h = h;
+		copy.gen = gen;
+	}
+
+	void sprite(Layer_t layer, int x, int y, const SpriteFrame * frame, int alpha)
+	{
+		sprite(layer, x, y, x, y, frame, alpha);
+	}
+
+	void sprite(Layer_t layer, int prev_x, int prev_y, int x, int y, const SpriteFrame * frame, int alpha)
+	{
+		if (frame == nullptr)
+			return;
+
+		Command cmd = make_cmd(RC_SPRITE, layer, x, y, frame->w, frame->h);
+		cmd.prev_x = prev_x;
+		cmd.prev_y = prev_y;
+		cmd.frame = frame;
+		cmd.alpha = alpha;
+		record(cmd);
+	}
+
+	void rect(Layer_t layer, int x, int y, int w, int h, uint8_t r, uint8_t g, uint8_t b, uint8_t a, bool grey)
+	{
+		rect_lerp(layer, x, y, x, y, w, h, r, g, b, a, grey);
+	}
+
+	void rect_lerp(Layer_t layer, int prev_x, int prev_y, int x, int y, int w, int h, uint8_t r, uint8_t g, uint8_t b, uint8_t a, bool grey)
+	{
+		Command cmd = make_cmd(RC_RECT, layer, x, y, w, h);
+		cmd.prev_x = prev_x;
+		cmd.prev_y = prev_y;
+		cmd.r = r;
+		cmd.g = g;
+		cmd.b = b;
+		cmd.a = a;
+		cmd.flag = grey;
+		record(cmd);
+	}
+
+	void text(Layer_t layer, int x, int y, int w, int h, const uint8_t * mask, uint8_t r, uint8_t g, uint8_t b)
+	{
+		Frame & frame = FRAMES[WRITE];
+
+		Command cmd = make_cmd(RC_TEXT, layer, x, y, w, h);
+		cmd.r = r;
+		cmd.g = g;
+		cmd.b = b;
+		cmd.offset = frame.bytes.size();
+		if (record(cmd) == false)
+			return;
+
+		// Text is re-rasterised by the recorder, keep a copy
+		frame.bytes.insert(frame.bytes.end(), mask, mask + w * h);
+	}
+
+	uint64_t publish(double time)
+	{
+		Frame & frame = FRAMES[WRITE];
+
+		std::stable_sort(frame.cmds.begin(), frame.cmds.end(), [](const Command & a, const Command & b) {
+			return a.layer < b.layer;
+		});
+
+		frame.sequence = ++SEQUENCE;
+		frame.time = time;
+
+		// Hand the frame over, continue recording into the previous ready slot. Its level
+		// copy may be a few frames old, it catches up through the row generations.
+		WRITE = READY.exchange(WRITE | SLOT_FRESH) & SLOT_INDEX;
+
+		return SEQUENCE;
+	}
+
+	uint64_t published()
+	{
+		return SEQUENCE;
+	}
+
+	bool acquire()
+	{
+		if ((READY.load() & SLOT_FRESH) == 0)
+			return false;
+
+		READ = READY.exchange(READ) & SLOT_INDEX;
+		ACQUIRED = FRAMES[READ].sequence;
+		return true;
+	}
+
+	void execute(float alpha)
+	{
+		ALPHA = std::min(std::max(alpha, 0.0f), 1.0f);
+
+		Frame & frame = FRAMES[READ];
+		frame.stats.executed = frame.cmds.size();
+		run(frame, ALPHA);
+	}
+
+	void replay()
+	{
+		run(FRAMES[READ], ALPHA);
+	}
+
+	const Frame & current()
+	{
+		return FRAMES[READ];
+	}
+
+	uint64_t acquired()
+	{
+		return ACQUIRED;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+struct SpriteFrame;
+
+namespace RenderQueue
+{
+
+	// Draw order, lower layers are executed first
+	enum Layer_t : uint8_t
+	{
+		RL_BACKGROUND = 0,
+		RL_LEVEL = 1,
+		RL_ENTITY = 2,
+		RL_DEBUG = 3,
+		RL_GUI = 4,
+		RL_HUD = 5
+	};
+
+	enum Command_t : uint8_t
+	{
+		RC_CLEAR = 0,
+		RC_LEVEL = 1,
+		RC_SPRITE = 2,
+		RC_RECT = 3,
+		RC_TEXT = 4
+	};
+
+	struct Command
+	{
+		Command_t type;
+		Layer_t layer;
+		bool camera;						// camera copied at record time
+		int cam_x, cam_y;
+		int x, y, w, h;						// untranslated rectangle, current tick
+		int prev_x, prev_y;					// position on the previous tick, lerped with alpha
+		uint8_t r, g, b, a;					// RC_RECT/RC_TEXT color
+		bool flag;							// RC_RECT grey, RC_LEVEL opaque
+		int alpha;							// RC_SPRITE forced alpha
+		int32_t argb;						// RC_CLEAR color
+		const SpriteFrame * frame;			// RC_SPRITE source (sprite sheets are immutable)
+		size_t offset;						// RC_TEXT mask offset in the frame byte arena
+	};
+
+	struct Stats
+	{
+		size_t submitted;					// commands given to the queue
+		size_t culled;						// dropped outside the camera view
+		size_t executed;					// handed to DisplayManager
+		size_t level_rows;					// level rows copied into the snapshot
+	};
+
+	// Level pixels owned by a frame, only rows changed since the last capture are copied
+	struct LevelCopy
+	{
+		const int32_t * src;
+		int w, h;
+		uint32_t gen;						// source generation at the last capture
+		std::vector<int32_t> pixels;
+	};
+
+	// Immutable snapshot of a recorded frame, owns copies of all mutable source data
+	struct Frame
+	{
+		std::vector<Command> cmds;
+		std::vector<uint8_t> bytes;			// text masks
+		LevelCopy level;
+		uint64_t sequence;					// publish() counter
+		double time;						// time at which the recorded tick state is current
+		Stats stats;
+	};
+
+	// Recording (simulation thread). Commands use DisplayManager::ACTIVE_CAMERA at call time.
+	void begin();
+	void clear(int32_t argb);
+	void level(
+		Layer_t layer,
+		int x,
+		int y,
+		int w,
+		int h,
+		const int32_t * pixels,
+		bool opaque = false,
+		const uint32_t * row_gens = nullptr,	// per-row generation of the last change, nullptr = copy all
+		uint32_t gen = 0						// current source generation
+	);
+	void sprite(Layer_t layer, int x, int y, const SpriteFrame * frame, int alpha = -1);
+	void sprite(Layer_t layer, int prev_x, int prev_y, int x, int y, const SpriteFrame * frame, int alpha = -1);
+	void rect(Layer_t layer, int x, int y, int w, int h, uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255, bool grey = false);
+	void rect_lerp(Layer_t layer, int prev_x, int prev_y, int x, int y, int w, int h, uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255, bool grey = false);
+	void text(Layer_t layer, int x, int y, int w, int h, const uint8_t * mask, uint8_t r, uint8_t g, uint8_t b);
+
+	// Sort the recorded frame by layer (stable) + hand it over to the render thread, returns its sequence
+	uint64_t publish(double time);
+
+	// Sequence of the last published frame
+	uint64_t published();
+
+	// Rendering (main thread). Swap in the newest published frame, false if there is none.
+	bool acquire();
+
+	// Execute the acquired frame in one pass, interpolating movement with alpha [0..1]
+	void execute(float alpha = 1.0f);
+
+	// Execute the acquired frame again with the last alpha, eg. for offline profiling
+	void replay();
+
+	// Acquired frame
+	const Frame & current();
+
+	// Sequence of the acquired frame, frames older than this are never executed again
+	uint64_t acquired();
+
+}
+
+#endif // RENDER_QUEUE_H
\ No newline at end of file
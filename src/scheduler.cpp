@@ -0,0 +1,169 @@
+#include "scheduler.h"
+#include <cmath>
+#include "3rdparty/mlibc_log.h"
+#include "clock.h"
+
+static uint64_t gcd(uint64_t a, uint64_t b)
+{
+	while (b != 0)
+	{
+		uint64_t r = a % b;
+		a = b;
+		b = r;
+	}
+	return a;
+}
+
+Scheduler::Scheduler(
+	float tickrate
+) :
+	m_tickrate(tickrate),
+	m_tick(0),
+	m_tickTime(0.0),
+	m_t(0.0f),
+	m_tasks(),
+	m_graph()
+{
+
+}
+
+Scheduler::~Scheduler()
+{
+
+}
+
+size_t Scheduler::add(const std::string & name, float rate, std::function<void(float t, float dt)> fn)
+{
+	return add(name, rate, FR_ALL, FR_ALL, fn);
+}
+
+size_t Scheduler::add(const std::string & name, float rate, uint32_t reads, uint32_t writes, std::function<void(float t, float dt)> fn, uint8_t flags)
+{
+	SchedulerTask task;
+	task.name = name;
+	task.t_last = -1.0;
+	task.runs = 0;
+	task.time = 0.0;
+	task.node = 0;
+	task.fn = fn;
+	schedule(task, rate);
+
+	// Frame tasks run outside the graph, see frame()
+	size_t id = m_tasks.size();
+	if (rate != RATE_FRAME)
+	{
+		task.node = m_graph.add(name, reads, writes, [this, id]() { run(m_tasks[id], m_t); }, flags);
+	}
+
+	m_tasks.push_back(task);
+
+	mlibc_inf("Scheduler::add(%s). Rate %.1f Hz, every %llu tick(s), phase %llu.", name.c_str(), rate, static_cast<unsigned long long>(task.interval), static_cast<unsigned long long>(task.phase));
+
+	return m_tasks.size() - 1;
+}
+
+void Scheduler::setRate(size_t id, float rate)
+{
+	if (id < m_tasks.size() && m_tasks[id].rate != rate)
+	{
+		schedule(m_tasks[id], rate);
+	}
+}
+
+void Scheduler::tick(float t)
+{
+	// Tasks not due on this tick are skipped by the graph
+	for (auto & task : m_tasks)
+	{
+		if (task.rate != RATE_FRAME)
+		{
+			m_graph.setEnabled(task.node, (m_tick + task.phase) % task.interval == 0);
+		}
+	}
+
+	m_t = t;
+	m_graph.run();
+	m_tickTime = m_graph.getTime();
+
+	m_tick++;
+}
+
+void Scheduler::frame(float t)
+{
+	for (auto & task : m_tasks)
+	{
+		if (task.rate == RATE_FRAME)
+		{
+			run(task, t);
+		}
+	}
+}
+
+const std::vector<SchedulerTask> & Scheduler::getTasks() const
+{
+	return m_tasks;
+}
+
+uint64_t Scheduler::getTick() const
+{
+	return m_tick;
+}
+
+double Scheduler::getTickTime() const
+{
+	return m_tickTime;
+}
+
+const FrameGraph & Scheduler::getGraph() const
+{
+	return m_graph;
+}
+
+void Scheduler::schedule(SchedulerTask & task, float rate)
+{
+	task.rate = rate;
+	task.interval = 1;
+	task.phase = 0;
+
+	if (rate == RATE_FRAME || rate >= m_tickrate || rate <= 0.0f)
+		return;
+
+	task.interval = static_cast<uint64_t>(std::lround(m_tickrate / rate));
+
+	// Stagger; over the hyperperiod, task runs on the ticks k with k = -phase (mod interval),
+	// so it meets another task iff the phases agree mod gcd(intervals), on 1 / lcm of the ticks.
+	// Pick the phase sharing the fewest ticks with the tasks scheduled so far.
+	double best = -1.0;
+	for (uint64_t phase = 0; phase < task.interval; phase++)
+	{
+		double shared = 0.0;
+		for (auto & other : m_tasks)
+		{
+			// Tasks running every tick share every phase alike
+			if (&other == &task || other.rate == RATE_FRAME || other.interval <= 1)
+				continue;
+
+			uint64_t g = gcd(task.interval, other.interval);
+			if ((phase + g - other.phase % g) % g == 0)
+				shared += static_cast<double>(g) / (static_cast<double>(task.interval) * static_cast<double>(other.interval));
+		}
+
+		if (best < 0.0 || shared < best)
+		{
+			best = shared;
+			task.phase = phase;
+		}
+	}
+}
+
+void Scheduler::run(SchedulerTask & task, float t)
+{
+	// dt is the time since the task last ran (one interval on ticks)
+	float dt = (task.t_last < 0.0) ? static_cast<float>(task.interval) / m_tickrate : static_cast<float>(t - task.t_last);
+
+	double t0 = Clock::seconds();
+	task.fn(t, dt);
+	task.time = Clock::seconds() - t0;
+	task.t_last = t;
+	task.runs++;
+}
\ No newline at end of file
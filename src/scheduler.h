@@ -0,0 +1,65 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include "frame_graph.h"
+
+// Run every frame instead of on simulation ticks
+#define RATE_FRAME -1.0f
+
+struct SchedulerTask
+{
+	std::string name;
+	float rate;									// Hz, RATE_FRAME or >= tickrate runs every tick
+	uint64_t interval;							// ticks between runs
+	uint64_t phase;								// tick offset, staggers tasks sharing an interval
+	double t_last;								// time of the previous run, -1 before the first
+	uint64_t runs;
+	double time;								// duration of the last run in seconds
+	size_t node;								// FrameGraph node, tick tasks only
+	std::function<void(float t, float dt)> fn;
+};
+
+// Multi-rate subsystem scheduler on top of the fixed timestep. Each task runs on
+// every interval'th tick (dt = interval * tick dt), phase-staggered so that it
+// shares as few ticks as possible with the other tasks, whatever their intervals.
+// Tick tasks are nodes of a FrameGraph, tasks declaring disjoint reads + writes
+// run concurrently.
+class Scheduler
+{
+public:
+	Scheduler(
+		float tickrate
+	);
+	~Scheduler();
+
+	// Add a task, returns its id. Without reads + writes it conflicts with every
+	// other tick task, so it runs in order after them.
+	size_t add(const std::string & name, float rate, std::function<void(float t, float dt)> fn);
+	size_t add(const std::string & name, float rate, uint32_t reads, uint32_t writes, std::function<void(float t, float dt)> fn, uint8_t flags = FN_NONE);
+	void setRate(size_t id, float rate);
+
+	// Run tasks due on this tick / frame
+	void tick(float t);
+	void frame(float t);
+
+	const std::vector<SchedulerTask> & getTasks() const;
+	uint64_t getTick() const;
+	double getTickTime() const;
+	const FrameGraph & getGraph() const;
+private:
+	void schedule(SchedulerTask & task, float rate);
+	void run(SchedulerTask & task, float t);
+
+	float m_tickrate;
+	uint64_t m_tick;
+	double m_tickTime;							// duration of the tasks run on the last tick
+	float m_t;									// time given to the running tick
+	std::vector<SchedulerTask> m_tasks;
+	FrameGraph m_graph;
+};
+
+#endif // SCHEDULER_H
\ No newline at end of file
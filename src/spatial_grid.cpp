@@ -0,0 +1,235 @@
+#include "spatial_grid.h"
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::SpatialGrid(
+	float width,
+	float height,
+	float cell
+) :
+	m_cell(cell),
+	m_invCell(1.0f / cell),
+	m_cols(1),
+	m_rows(1),
+	m_handles(),
+	m_minP(),
+	m_maxP(),
+	m_stamp(),
+	m_cellStart(),
+	m_cellItems(),
+	m_query(0)
+{
+	resize(width, height);
+}
+
+SpatialGrid::~SpatialGrid()
+{
+
+}
+
+void SpatialGrid::resize(float width, float height)
+{
+	m_cols = std::max(1, static_cast<int32_t>(std::ceil(width * m_invCell)));
+	m_rows = std::max(1, static_cast<int32_t>(std::ceil(height * m_invCell)));
+	m_cellStart.assign(m_cols * m_rows + 1, 0);
+	m_cellItems.clear();
+}
+
+void SpatialGrid::clear()
+{
+	m_handles.clear();
+	m_minP.clear();
+	m_maxP.clear();
+}
+
+void SpatialGrid::insert(EntityHandle handle, const AABB & aabb)
+{
+	m_handles.push_back(handle);
+	m_minP.push_back(aabb.getMinP());
+	m_maxP.push_back(aabb.getMaxP());
+}
+
+void SpatialGrid::build()
+{
+	size_t n = m_handles.size();
+	std::fill(m_cellStart.begin(), m_cellStart.end(), 0);
+
+	// Count the cells each item covers
+	for (size_t i = 0; i < n; i++)
+	{
+		int32_t x0, y0, x1, y1;
+		cellRange(m_minP[i], m_maxP[i], x0, y0, x1, y1);
+
+		for (int32_t y = y0; y <= y1; y++)
+			for (int32_t x = x0; x <= x1; x++)
+				m_cellStart[x + y * m_cols + 1]++;
+	}
+
+	// Prefix sum into range starts
+	for (size_t c = 1; c < m_cellStart.size(); c++)
+	{
+		m_cellStart[c] += m_cellStart[c - 1];
+	}
+	m_cellItems.resize(m_cellStart.back());
+
+	// Scatter using m_cellStart[c] as the write cursor of cell c, it ends up at the end of the cell so shift back
+	for (size_t i = 0; i < n; i++)
+	{
+		int32_t x0, y0, x1, y1;
+		cellRange(m_minP[i], m_maxP[i], x0, y0, x1, y1);
+
+		for (int32_t y = y0; y <= y1; y++)
+			for (int32_t x = x0; x <= x1; x++)
+				m_cellItems[m_cellStart[x + y * m_cols]++] = static_cast<uint32_t>(i);
+	}
+	for (size_t c = m_cellStart.size() - 1; c > 0; c--)
+	{
+		m_cellStart[c] = m_cellStart[c - 1];
+	}
+	m_cellStart[0] = 0;
+
+	m_stamp.assign(n, m_query);
+}
+
+void SpatialGrid::queryAABB(const Math::vec2 & minP, const Math::vec2 & maxP, std::vector<EntityHandle> & out)
+{
+	int32_t x0, y0, x1, y1;
+	cellRange(minP, maxP, x0, y0, x1, y1);
+	m_query++;
+
+	for (int32_t y = y0; y <= y1; y++)
+	{
+		for (int32_t x = x0; x <= x1; x++)
+		{
+			int32_t c = x + y * m_cols;
+			for (uint32_t k = m_cellStart[c]; k < m_cellStart[c + 1]; k++)
+			{
+				uint32_t i = m_cellItems[k];
+				if (visit(i) == false)
+					continue;
+
+				if (m_minP[i].x <= maxP.x && m_maxP[i].x >= minP.x && m_minP[i].y <= maxP.y && m_maxP[i].y >= minP.y)
+				{
+					out.push_back(m_handles[i]);
+				}
+			}
+		}
+	}
+}
+
+void SpatialGrid::queryRadius(const Math::vec2 & center, float radius, std::vector<EntityHandle> & out)
+{
+	int32_t x0, y0, x1, y1;
+	cellRange(center - radius, center + radius, x0, y0, x1, y1);
+	m_query++;
+
+	float r2 = radius * radius;
+	for (int32_t y = y0; y <= y1; y++)
+	{
+		for (int32_t x = x0; x <= x1; x++)
+		{
+			int32_t c = x + y * m_cols;
+			for (uint32_t k = m_cellStart[c]; k < m_cellStart[c + 1]; k++)
+			{
+				uint32_t i = m_cellItems[k];
+				if (visit(i) == false)
+					continue;
+
+				// Distance from the center to the closest point of the box
+				float dx = center.x - std::max(m_minP[i].x, std::min(center.x, m_maxP[i].x));
+				float dy = center.y - std::max(m_minP[i].y, std::min(center.y, m_maxP[i].y));
+				if (dx * dx + dy * dy <= r2)
+				{
+					out.push_back(m_handles[i]);
+				}
+			}
+		}
+	}
+}
+
+bool SpatialGrid::querySegment(const Math::vec2 & from, const Math::vec2 & to, EntityHandle & hit, float & t, EntityHandle ignore)
+{
+	// Sweeps are a few pixels per tick, the cells under the segment's bounds are enough
+	Math::vec2 minP(std::min(from.x, to.x), std::min(from.y, to.y));
+	Math::vec2 maxP(std::max(from.x, to.x), std::max(from.y, to.y));
+	int32_t x0, y0, x1, y1;
+	cellRange(minP, maxP, x0, y0, x1, y1);
+	m_query++;
+
+	Math::vec2 d = to - from;
+	bool found = false;
+	t = 1.0f;
+
+	for (int32_t y = y0; y <= y1; y++)
+	{
+		for (int32_t x = x0; x <= x1; x++)
+		{
+			int32_t c = x + y * m_cols;
+			for (uint32_t k = m_cellStart[c]; k < m_cellStart[c + 1]; k++)
+			{
+				uint32_t i = m_cellItems[k];
+				if (visit(i) == false || m_handles[i] == ignore)
+					continue;
+
+				// Slab test, entry + exit parameters along both axes
+				float t_min = 0.0f;
+				float t_max = t;
+				bool miss = false;
+				for (int a = 0; a < 2 && miss == false; a++)
+				{
+					float o = (a == 0) ? from.x : from.y;
+					float v = (a == 0) ? d.x : d.y;
+					float lo = (a == 0) ? m_minP[i].x : m_minP[i].y;
+					float hi = (a == 0) ? m_maxP[i].x : m_maxP[i].y;
+
+					if (v == 0.0f)
+					{
+						miss = (o < lo || o > hi);
+						continue;
+					}
+
+					float t0 = (lo - o) / v;
+					float t1 = (hi - o) / v;
+					if (t0 > t1)
+						std::swap(t0, t1);
+
+					t_min = std::max(t_min, t0);
+					t_max = std::min(t_max, t1);
+					miss = (t_min > t_max);
+				}
+
+				if (miss == false)
+				{
+					hit = m_handles[i];
+					t = t_min;
+					found = true;
+				}
+			}
+		}
+	}
+
+	return found;
+}
+
+size_t SpatialGrid::size() const
+{
+	return m_handles.size();
+}
+
+void SpatialGrid::cellRange(const Math::vec2 & minP, const Math::vec2 & maxP, int32_t & x0, int32_t & y0, int32_t & x1, int32_t & y1) const
+{
+	x0 = std::min(std::max(static_cast<int32_t>(std::floor(minP.x * m_invCell)), 0), m_cols - 1);
+	y0 = std::min(std::max(static_cast<int32_t>(std::floor(minP.y * m_invCell)), 0), m_rows - 1);
+	x1 = std::min(std::max(static_cast<int32_t>(std::floor(maxP.x * m_invCell)), 0), m_cols - 1);
+	y1 = std::min(std::max(static_cast<int32_t>(std::floor(maxP.y * m_invCell)), 0), m_rows - 1);
+}
+
+bool SpatialGrid::visit(uint32_t item)
+{
+	// Items spanning several cells are only tested once per query
+	if (m_stamp[item] == m_query)
+		return false;
+
+	m_stamp[item] = m_query;
+	return true;
+}
\ No newline at end of file
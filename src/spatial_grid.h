@@ -0,0 +1,61 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <vector>
+#include <cstdint>
+#include "math.h"
+#include "aabb.h"
+#include "entity_handle.h"
+
+// Cell edge in pixels, around the size of a player
+#define GRID_CELL_SIZE 32.0f
+
+// Uniform grid broadphase over the level. Items are inserted every tick and
+// binned with a counting sort into one flat array, each cell being a range of
+// it; items outside the level are clamped into the border cells.
+class SpatialGrid
+{
+public:
+	SpatialGrid(
+		float width = 0.0f,
+		float height = 0.0f,
+		float cell = GRID_CELL_SIZE
+	);
+	~SpatialGrid();
+
+	void resize(float width, float height);
+
+	// Rebuild: clear(), insert() every item, then build()
+	void clear();
+	void insert(EntityHandle handle, const AABB & aabb);
+	void build();
+
+	// Queries, results are appended to out, each item once
+	void queryAABB(const Math::vec2 & minP, const Math::vec2 & maxP, std::vector<EntityHandle> & out);
+	void queryRadius(const Math::vec2 & center, float radius, std::vector<EntityHandle> & out);
+	// Nearest item the segment enters, t in 0..1 along it
+	bool querySegment(const Math::vec2 & from, const Math::vec2 & to, EntityHandle & hit, float & t, EntityHandle ignore = EntityHandle());
+
+	size_t size() const;
+private:
+	void cellRange(const Math::vec2 & minP, const Math::vec2 & maxP, int32_t & x0, int32_t & y0, int32_t & x1, int32_t & y1) const;
+	bool visit(uint32_t item);
+
+	float m_cell;
+	float m_invCell;
+	int32_t m_cols;
+	int32_t m_rows;
+
+	// Items
+	std::vector<EntityHandle> m_handles;
+	std::vector<Math::vec2> m_minP;
+	std::vector<Math::vec2> m_maxP;
+	std::vector<uint32_t> m_stamp;			// last query that visited the item
+
+	// Cells, items of cell c are m_cellItems[m_cellStart[c]..m_cellStart[c + 1])
+	std::vector<uint32_t> m_cellStart;
+	std::vector<uint32_t> m_cellItems;
+	uint32_t m_query;
+};
+
+#endif // SPATIAL_GRID_H
\ No newline at end of file
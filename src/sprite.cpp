@@ -4,35 +4,126 @@
 #include "3rdparty/json.hpp"
 #include "3rdparty/mlibc_log.h"
 #include "texture_manager.h"
-#include "display_manager.h"
+#include "render_queue.h"
 
 using json = nlohmann::json;
 
+static std::map<std::string, SpriteSheet *> LOADED_SHEETS = std::map<std::string, SpriteSheet *>();
+
 Sprite::Sprite(
-	const std::string & filePath
+	SpriteSheet * sheet,
+	const std::string & anim
 ) :
-	m_filePath(filePath),
-	m_sheet(nullptr),
-	m_anims(),
-	m_animRepeat(true),
-	m_animIdent("GO_RIGHT"),
+	m_sheet(sheet),
+	m_anim(nullptr),
 	m_animFrame(NULL),
 	m_animate(true)
 {
+	setAnim(anim);
+}
+
+Sprite::~Sprite()
+{
+
+}
+
+void Sprite::update(float t, float dt)
+{
+	// Do not continue if current animation does not exist
+	if (m_anim == nullptr || m_anim->frames.empty())
+	{
+		return;
+	}
+
+	// Calculate current anim frame
+	if (m_animate)
+	{
+		// Calculate current frame index, scale by anim dt
+		m_animFrame = static_cast<size_t>(t / m_anim->dt) % m_anim->frames.size();
+	}
+}
+
+void Sprite::render(int x, int y, int alpha)
+{
+	render(x, y, x, y, alpha);
+}
+
+void Sprite::render(int prev_x, int prev_y, int x, int y, int alpha)
+{
+	// Do not continue if current animation does not exist
+	if (m_anim == nullptr)
+	{
+		return;
+	}
+
+	// Get current animation frame & plot it, either forcing alpha or using sprite alpha
+	SpriteFrame * frame = &m_anim->frames[m_animFrame];
+	RenderQueue::sprite(RenderQueue::RL_ENTITY, prev_x, prev_y, x, y, frame, alpha);
+}
+
+void Sprite::setAnim(const std::string & anim)
+{
+	m_anim = nullptr;
+	m_animFrame = 0;
+
+	if (m_sheet == nullptr)
+	{
+		return;
+	}
+
+	auto it = m_sheet->anims.find(anim);
+	if (it != m_sheet->anims.end())
+	{
+		m_anim = &it->second;
+	}
+}
+
+SpriteSheet * Sprite::getSheet() const
+{
+	return m_sheet;
+}
+
+SpriteAnim * Sprite::getCurrentAnim() const
+{
+	return m_anim;
+}
+
+SpriteFrame * Sprite::getCurrentFrame() const
+{
+	// Do not continue if current animation does not exist
+	if (m_anim == nullptr)
+	{
+		return nullptr;
+	}
+
+	return &m_anim->frames[m_animFrame];
+}
+
+SpriteSheet * Sprite::load_sheet(const std::string & file_path)
+{
+	auto loaded = LOADED_SHEETS.find(file_path);
+	if (loaded != LOADED_SHEETS.end())
+	{
+		return loaded->second;
+	}
+
 	// Read sprite cfg from JSON file
-	std::ifstream spr_file("./data/spr/" + m_filePath, std::ifstream::binary);
+	std::ifstream spr_file("./data/spr/" + file_path, std::ifstream::binary);
 
 	if (spr_file.is_open() == false)
 	{
-		throw std::runtime_error("Sprite::Sprite(). Error loading sprite cfg file into memory!");
+		throw std::runtime_error("Sprite::load_sheet(). Error loading sprite cfg file into memory!");
 	}
 
 	json spr_json;
 	spr_file >> spr_json;
 	spr_file.close();
 
+	SpriteSheet * sheet = new SpriteSheet();
+	sheet->file_path = file_path;
+
 	// Load spritesheet texture
-	m_sheet = TextureManager::load_texture(spr_json["sheet"].get<std::string>());
+	sheet->texture = TextureManager::load_texture(spr_json["sheet"].get<std::string>());
 
 	// Parse sprite animations
 	json & json_anims = spr_json["anims"];
@@ -63,100 +154,43 @@ Sprite::Sprite(
 				json_frame["h"].get<int>()
 			);
 
-			// Sample frame pixel data from spritesheet texture data
-			frame.data = TextureManager::sample_texture(m_sheet->file_path, frame.x * frame.w, frame.y * frame.h, frame.w, frame.h);
+			// Copy frame pixel data from spritesheet texture data into a contiguous block
+			frame.pixels.resize(frame.w * frame.h);
+			for (int p_y = 0; p_y < frame.h; p_y++)
+			{
+				for (int p_x = 0; p_x < frame.w; p_x++)
+				{
+					frame.pixels[p_x + p_y * frame.w] = TextureManager::sample_texture(sheet->texture->file_path, frame.x * frame.w + p_x, frame.y * frame.h + p_y);
+				}
+			}
+
+			// Pre-compile the frame into blittable spans
+			Blitter::encode_spans(frame.pixels.data(), frame.w, frame.h, frame.spans, frame.rows);
 
 			// Push to anim frame vector
 			anim.frames.push_back(frame);
 		}
 
 		// Push to anim map
-		m_anims[anim.identifier] = anim;
+		sheet->anims[anim.identifier] = anim;
 
-		mlibc_dbg("Sprite::Sprite(). Parsed sprite animation. identifier: %s, frames: %zu", anim.identifier.c_str(), anim.frames.size());
+		mlibc_dbg("Sprite::load_sheet(). Parsed sprite animation. identifier: %s, frames: %zu", anim.identifier.c_str(), anim.frames.size());
 	}
 
-	m_animRepeat = spr_json["anim_repeat"].get<bool>();
-}
+	sheet->anim_repeat = spr_json["anim_repeat"].get<bool>();
 
-Sprite::~Sprite()
-{
+	LOADED_SHEETS[file_path] = sheet;
 
-}
+	mlibc_inf("Sprite::load_sheet(%s). Success, parsed sprite sheet.", file_path.c_str());
 
-void Sprite::update(float t, float dt)
-{
-	// Do not continue if current animation does not exist
-	if (m_anims.count(m_animIdent) == 0)
-	{
-		return;
-	}
-
-	// Calculate current anim frame
-	if (m_animate)
-	{
-		// Get anim data
-		SpriteAnim * anim = &m_anims[m_animIdent];
-
-		// Calculate current frame index, scale by anim dt
-		m_animFrame = static_cast<size_t>(t / anim->dt) % anim->frames.size();
-	}
-}
-
-void Sprite::render(int x, int y, int alpha)
-{
-	// Do not continue if current animation does not exist
-	if (m_anims.count(m_animIdent) == 0)
-	{
-		return;
-	}
-
-	// Get current animation + frame & render it
-	SpriteAnim * anim = &m_anims[m_animIdent];
-	SpriteFrame * frame = &anim->frames[m_animFrame];
-	for (size_t i = 0; i < frame->data.size(); i++)
-	{
-		// Get pixel at x,y
-		size_t p_x = i % frame->w;
-		size_t p_y = static_cast<size_t>(std::floor(i / frame->w));
-		int32_t argb = *frame->data[p_y + p_x * frame->w];
-
-		// Decode argb to rgba components
-		auto a = (argb & 0xFF000000) >> 24;
-		auto r = (argb & 0x00FF0000) >> 16;
-		auto g = (argb & 0x0000FF00) >> 8;
-		auto b = (argb & 0x000000FF);
-
-		// Either force alpha or use sprite alpha
-		if (alpha != -1 && a != 0)
-		{
-			a = static_cast<uint8_t>(alpha);
-		}
-
-		// Plot it!
-		DisplayManager::set_pixel(x + p_x, y + p_y, r, g, b, a, false);
-	}
+	return sheet;
 }
 
-SpriteAnim * Sprite::getCurrentAnim()
+void Sprite::unload_sheets()
 {
-	// Do not continue if current animation does not exist
-	if (m_anims.count(m_animIdent) == 0)
+	for (auto s : LOADED_SHEETS)
 	{
-		return nullptr;
+		delete s.second;
 	}
-
-	return &m_anims[m_animIdent];
-}
-
-SpriteFrame * Sprite::getCurrentFrame()
-{
-	// Do not continue if current animation does not exist
-	if (m_anims.count(m_animIdent) == 0)
-	{
-		return nullptr;
-	}
-
-	SpriteAnim * anim = &m_anims[m_animIdent];
-	return &anim->frames[m_animFrame];
+	LOADED_SHEETS.clear();
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <vector>
 #include <map>
 #include <cstdint>
+#include "blitter.h"
 
 namespace TextureManager
 {
@@ -18,22 +19,25 @@ struct SpriteFrame
 	int w;									// spritesheet frame width
 	int h;									// spritesheet frame height
 	// float t;								// frame length in seconds			<-- DO WE WANT THIS?
-	std::vector<int32_t *> data;			// frame data from spritesheet
+	std::vector<int32_t> pixels;			// frame pixels copied from spritesheet, w * h ARGB
+	std::vector<Blitter::Span> spans;		// run-length encoded opaque/translucent/transparent spans
+	std::vector<uint32_t> rows;				// first span index per row, h + 1 entries
 
 	SpriteFrame(
 		int x = 0,
 		int y = 0,
 		int w = 16,
-		int h = 16,
+		int h = 16
 		// float t = 0.1f,														<-- DO WE WANT THIS?
-		std::vector<int32_t *> data = std::vector<int32_t *>()
 	) :
 		x(x),
 		y(y),
 		w(w),
 		h(h),
 		//t(t),
-		data(data)
+		pixels(),
+		spans(),
+		rows()
 	{
 
 	}
@@ -58,25 +62,51 @@ struct SpriteAnim
 	}
 };
 
+// Shared sprite data, parsed once per file + shared by every instance
+struct SpriteSheet
+{
+	std::string file_path;					// sprite cfg file
+	TextureManager::Texture * texture;		// spritesheet texture
+	std::map<std::string, SpriteAnim> anims;	// animations by identifier
+	bool anim_repeat;						// loop animations
+
+	SpriteSheet() :
+		file_path(),
+		texture(nullptr),
+		anims(),
+		anim_repeat(true)
+	{
+
+	}
+};
+
+// Sprite instance, only the per-instance animation state; cheap to copy +
+// stored by value in component arrays
 class Sprite
 {
 public:
 	Sprite(
-		const std::string & filePath
+		SpriteSheet * sheet = nullptr,
+		const std::string & anim = "GO_RIGHT"
 	);
 	~Sprite();
 
 	void update(float t, float dt);
 	void render(int x, int y, int alpha = -1);
+	void render(int prev_x, int prev_y, int x, int y, int alpha = -1);
+
+	void setAnim(const std::string & anim);
+
+	SpriteSheet * getSheet() const;
+	SpriteAnim * getCurrentAnim() const;
+	SpriteFrame * getCurrentFrame() const;
 
-	SpriteAnim * getCurrentAnim();
-	SpriteFrame * getCurrentFrame();
+	// Sheets (cached by file path, freed on unload_sheets())
+	static SpriteSheet * load_sheet(const std::string & file_path);
+	static void unload_sheets();
 private:
-	std::string m_filePath;
-	TextureManager::Texture * m_sheet;
-	std::map<std::string, SpriteAnim> m_anims;
-	bool m_animRepeat;
-	std::string m_animIdent;
+	SpriteSheet * m_sheet;
+	SpriteAnim * m_anim;					// current animation in m_sheet, nullptr if missing
 	size_t m_animFrame;
 	bool m_animate;
 };
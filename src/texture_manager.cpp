@@ -1,6 +1,7 @@
 #include "texture_manager.h"
 #include <iostream>
 #include <fstream>
+#include <cctype>
 #define STB_IMAGE_IMPLEMENTATION
 #include "3rdparty/stb_image.h"
 #include "3rdparty/mlibc_log.h"
@@ -15,6 +16,7 @@ namespace TextureManager
 	const std::string DATA_DIR_FNT = "./data/fnt/";
 	std::map<std::string, Texture *> LOADED_TEXTURES = std::map<std::string, Texture *>();
 	std::map<std::string, Font *> LOADED_FONTS = std::map<std::string, Font *>();
+	std::map<GlyphKey, GlyphSet *> LOADED_GLYPHS = std::map<GlyphKey, GlyphSet *>();
 
 	// Init
 	void init()
@@ -43,6 +45,11 @@ namespace TextureManager
 	// Quit (clears memory)
 	void quit()
 	{
+		for (auto g : LOADED_GLYPHS)
+		{
+			delete g.second;
+		}
+
 		for (auto t : LOADED_TEXTURES)
 		{
 			mlibc_inf("TextureManager::quit(). Destroy texture.");
@@ -225,4 +232,58 @@ namespace TextureManager
 		return LOADED_FONTS[file_path];
 	}
 
+	// Glyphs (font pre-scaled to a target char size)
+	GlyphSet * const load_glyphs(Font * font, int width, int height)
+	{
+		GlyphKey key(font, width, height);
+
+		if (LOADED_GLYPHS.count(key) == 0)
+		{
+			GlyphSet * glyphs = new GlyphSet;
+			glyphs->font = font;
+			glyphs->width = width;
+			glyphs->height = height;
+			glyphs->masks = std::vector<uint8_t>(256 * width * height, 0);
+			glyphs->visible = std::vector<bool>(256, false);
+
+			// Calculate font size <-> char size ratio
+			float char_rat_w = static_cast<float>(font->char_width) / static_cast<float>(width);
+			float char_rat_h = static_cast<float>(font->char_height) / static_cast<float>(height);
+
+			// Pre-scale the alpha channel of each mapped char
+			Texture * texture = font->texture;
+			for (auto & kv : font->char_map)
+			{
+				const CharIdx & char_idx = kv.second;
+				unsigned char c = static_cast<unsigned char>(kv.first);
+
+				// Spaces are never drawn
+				if (isspace(char_idx.key))
+					continue;
+
+				uint8_t * mask = &glyphs->masks[c * width * height];
+				for (int i = 0; i < height; i++)
+				{
+					for (int j = 0; j < width; j++)
+					{
+						// Calculate texcoords and sample the pixel + scale according to size diff
+						int char_tex_x = char_idx.x * font->char_width + static_cast<int>(j * char_rat_w);
+						int char_tex_y = char_idx.y * font->char_height + static_cast<int>(i * char_rat_h);
+						int32_t char_argb = texture->data[(char_tex_x % texture->width) + (char_tex_y % texture->height) * texture->width];
+
+						mask[j + i * width] = static_cast<uint8_t>((char_argb & 0xFF000000) >> 24);
+					}
+				}
+
+				glyphs->visible[c] = true;
+			}
+
+			LOADED_GLYPHS[key] = glyphs;
+
+			mlibc_inf("TextureManager::load_glyphs(%s, %d, %d). Pre-scaled font glyphs into memory.", font->file_path.c_str(), width, height);
+		}
+
+		return LOADED_GLYPHS[key];
+	}
+
 }
\ No newline at end of file
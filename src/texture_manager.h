@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <tuple>
 #include <cstdint>
 
 namespace TextureManager
@@ -30,10 +31,26 @@ namespace TextureManager
 		std::map<char, CharIdx> char_map;
 	};
 
+	struct GlyphSet
+	{
+		Font * font;
+		int width, height;					// target glyph size in pixels
+		std::vector<uint8_t> masks;			// pre-scaled coverage masks, 256 glyphs * width * height
+		std::vector<bool> visible;			// 256 flags, false for spaces + unmapped chars
+
+		inline const uint8_t * mask(char c) const
+		{
+			return &masks[static_cast<unsigned char>(c) * width * height];
+		}
+	};
+
+	typedef std::tuple<Font *, int, int> GlyphKey;
+
 	extern const std::string DATA_DIR_TEX;
 	extern const std::string DATA_DIR_FNT;
 	extern std::map<std::string, Texture *> LOADED_TEXTURES;
 	extern std::map<std::string, Font *> LOADED_FONTS;
+	extern std::map<GlyphKey, GlyphSet *> LOADED_GLYPHS;
 
 	// Init
 	void init();
@@ -49,6 +66,9 @@ namespace TextureManager
 	// Fonts
 	Font * const load_font(const std::string & file_path);
 
+	// Glyphs (font pre-scaled to a target char size)
+	GlyphSet * const load_glyphs(Font * font, int width, int height);
+
 }
 
 #endif // TEXTURE_MANAGER_H
\ No newline at end of file
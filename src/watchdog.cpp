@@ -0,0 +1,148 @@
+#include "watchdog.h"
+#include <algorithm>
+#include "3rdparty/mlibc_log.h"
+#include "scheduler.h"
+
+Watchdog::Watchdog(
+	double budget,
+	uint32_t degrade_ticks,
+	uint32_t restore_ticks,
+	double restore_ratio
+) :
+	m_budget(budget),
+	m_degradeTicks(degrade_ticks),
+	m_restoreTicks(restore_ticks),
+	m_restoreRatio(restore_ratio),
+	m_over(0),
+	m_under(0),
+	m_window(),
+	m_windowPos(0),
+	m_windowCount(0),
+	m_windowSum(0.0),
+	m_overruns(0),
+	m_level(0),
+	m_policies()
+{
+
+}
+
+Watchdog::~Watchdog()
+{
+
+}
+
+void Watchdog::add(const std::string & name, std::function<void()> degrade, std::function<void()> restore)
+{
+	m_policies.push_back(DegradePolicy{ name, degrade, restore });
+}
+
+void Watchdog::update(const Scheduler & scheduler)
+{
+	double t_tick = scheduler.getTickTime();
+	if (t_tick > m_budget)
+		m_overruns++;
+
+	// Window covers one run of every task, restarts when the intervals change
+	uint64_t interval = 1;
+	for (auto & task : scheduler.getTasks())
+	{
+		if (task.rate != RATE_FRAME && task.interval > interval)
+			interval = task.interval;
+	}
+	if (m_window.size() != interval)
+	{
+		m_window.assign(interval, 0.0);
+		reset();
+	}
+
+	m_windowSum += t_tick - m_window[m_windowPos];
+	m_window[m_windowPos] = t_tick;
+	m_windowPos = (m_windowPos + 1) % m_window.size();
+	m_windowCount++;
+
+	// Judge full windows only
+	if (m_windowCount < m_window.size())
+		return;
+
+	double t_avg = m_windowSum / static_cast<double>(m_window.size());
+	if (t_avg > m_budget)
+	{
+		m_over++;
+		m_under = 0;
+	}
+	else
+	{
+		m_over = 0;
+		m_under = (t_avg < m_budget * m_restoreRatio) ? m_under + 1 : 0;
+	}
+
+	// Sustained overrun, blame the slowest task + degrade one step
+	if (m_over >= m_degradeTicks)
+	{
+		m_over = 0;
+
+		const SchedulerTask * slowest = nullptr;
+		for (auto & task : scheduler.getTasks())
+		{
+			if (slowest == nullptr || task.time > slowest->time)
+				slowest = &task;
+		}
+
+		mlibc_inf(
+			"Watchdog::update(). Ticks averaged %.2f ms of a %.2f ms budget over %zu tick(s), slowest task '%s' %.2f ms.",
+			t_avg * 1000.0,
+			m_budget * 1000.0,
+			m_window.size(),
+			(slowest) ? slowest->name.c_str() : "-",
+			(slowest) ? slowest->time * 1000.0 : 0.0
+		);
+
+		if (m_level < m_policies.size())
+		{
+			mlibc_inf("Watchdog::update(). Degrading: %s.", m_policies[m_level].name.c_str());
+			m_policies[m_level].degrade();
+			m_level++;
+			reset();
+		}
+	}
+
+	// Sustained headroom, undo the last degradation
+	if (m_under >= m_restoreTicks)
+	{
+		m_under = 0;
+
+		if (m_level > 0)
+		{
+			m_level--;
+			mlibc_inf("Watchdog::update(). Restoring: %s.", m_policies[m_level].name.c_str());
+			m_policies[m_level].restore();
+			reset();
+		}
+	}
+}
+
+void Watchdog::setBudget(double budget)
+{
+	m_budget = budget;
+}
+
+size_t Watchdog::getLevel() const
+{
+	return m_level;
+}
+
+uint64_t Watchdog::getOverruns() const
+{
+	return m_overruns;
+}
+
+void Watchdog::reset()
+{
+	// Ticks before a policy change do not tell anything about the ticks after it
+	std::fill(m_window.begin(), m_window.end(), 0.0);
+	m_windowPos = 0;
+	m_windowCount = 0;
+	m_windowSum = 0.0;
+	m_over = 0;
+	m_under = 0;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+class Scheduler;
+
+struct DegradePolicy
+{
+	std::string name;
+	std::function<void()> degrade;
+	std::function<void()> restore;
+};
+
+// Tick budget watchdog. Sustained overruns apply the next degradation policy
+// (in the order added), sustained headroom restores the last applied one. Ticks
+// are judged by their average cost over the longest task interval, so tasks that
+// only run every n'th tick are spread over the ticks in between.
+class Watchdog
+{
+public:
+	Watchdog(
+		double budget,						// seconds of task time allowed per tick
+		uint32_t degrade_ticks = 16,		// consecutive ticks with the average over budget before degrading
+		uint32_t restore_ticks = 256,		// consecutive ticks with the average under restore_ratio * budget before restoring
+		double restore_ratio = 0.5
+	);
+	~Watchdog();
+
+	void add(const std::string & name, std::function<void()> degrade, std::function<void()> restore);
+
+	// Check the tick the scheduler just ran
+	void update(const Scheduler & scheduler);
+
+	void setBudget(double budget);
+	size_t getLevel() const;
+	uint64_t getOverruns() const;
+private:
+	void reset();
+
+	double m_budget;
+	uint32_t m_degradeTicks;
+	uint32_t m_restoreTicks;
+	double m_restoreRatio;
+	uint32_t m_over;						// consecutive ticks with the average over budget
+	uint32_t m_under;						// consecutive ticks with the average under restore_ratio * budget
+	std::vector<double> m_window;			// tick times over the longest task interval, ring
+	size_t m_windowPos;
+	size_t m_windowCount;					// ticks in the window since the last reset
+	double m_windowSum;
+	uint64_t m_overruns;
+	size_t m_level;							// policies applied
+	std::vector<DegradePolicy> m_policies;
+};
+
+#endif // WATCHDOG_H
\ No newline at end of file
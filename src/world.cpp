@@ -0,0 +1,644 @@
+#include "world.h"
+#include <algorithm>
+#include "game.h"
+#include "level.h"
+#include "sprite.h"
+#include "audio_manager.h"
+#include "input_manager.h"
+#include "render_queue.h"
+#include "job_manager.h"
+#include "3rdparty/mlibc_log.h"
+
+// Default weapon until weapons get their own data
+static const ProjectileDesc WEAPON_PROJECTILE = { 400.0f, 2.0f, Math::vec2(0.0f, -120.0f), 4, 5.0f, 255, 220, 96 };
+static const float WEAPON_INTERVAL = 0.1f;
+
+World::World(
+	Game * const game,
+	Level * level,
+	size_t capacity
+) :
+	m_game(game),
+	m_level(level),
+	m_pva(),
+	m_transform(),
+	m_size(),
+	m_aabb(),
+	m_state(),
+	m_time(),
+	m_health(),
+	m_ctrl(),
+	m_controller(),
+	m_facing(),
+	m_reload(),
+	m_props(),
+	m_sprite(),
+	m_slots(),
+	m_freeSlots(),
+	m_slotOf(),
+	m_names(),
+	m_bindKey(),
+	m_bindBit(),
+	m_bindController(),
+	m_actions(),
+	m_commands(),
+	m_edits(),
+	m_projectiles(),
+	m_grid(),
+	m_query(),
+	m_capacity(0),
+	m_allocStats()
+{
+	if (m_level)
+	{
+		m_grid.resize(static_cast<float>(m_level->getCfg().width), static_cast<float>(m_level->getCfg().height));
+	}
+
+	reserve(capacity);
+	resetAllocStats();
+}
+
+World::~World()
+{
+
+}
+
+EntityHandle World::create(const EntityProps & props, const Sprite & sprite, uint8_t controller)
+{
+	// Out of reserved entities, grow every array together
+	if (size() == m_capacity)
+	{
+		reserve(m_capacity * 2);
+	}
+
+	// Collision extents from the sprite frame
+	Math::vec2 size;
+	SpriteFrame * frame = sprite.getCurrentFrame();
+	if (frame)
+	{
+		size = Math::vec2(static_cast<float>(frame->w), static_cast<float>(frame->h));
+	}
+
+	m_pva.push_back(Physics::PosVelAcc(props.spawn));
+	m_transform.push_back(Physics::Transform(props.spawn));
+	m_size.push_back(size);
+	m_aabb.push_back(AABB());
+	m_state.push_back(props.state);
+	m_time.push_back(0.0f);
+	m_health.push_back(props.health);
+	m_ctrl.push_back(0);
+	m_controller.push_back(controller);
+	m_facing.push_back(1.0f);
+	m_reload.push_back(0.0f);
+	m_props.push_back(props);
+	m_sprite.push_back(sprite);
+
+	// Take a free slot, generations start at 1 so a zeroed handle is never valid
+	uint32_t slot;
+	if (m_freeSlots.empty())
+	{
+		slot = static_cast<uint32_t>(m_slots.size());
+		m_slots.push_back(Slot{ 0, 1 });
+	}
+	else
+	{
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	m_slots[slot].dense = static_cast<uint32_t>(m_pva.size() - 1);
+	m_slotOf.push_back(slot);
+
+	m_allocStats.created++;
+
+	EntityHandle handle(slot, m_slots[slot].gen);
+	if (props.name.empty() == false)
+	{
+		m_names[props.name] = handle;
+	}
+
+	return handle;
+}
+
+void World::destroy(EntityHandle handle)
+{
+	size_t i = resolve(handle);
+	if (i >= size())
+		return;
+
+	m_allocStats.destroyed++;
+
+	// Retire the slot, bumping the generation invalidates outstanding handles
+	auto name = m_names.find(m_props[i].name);
+	if (name != m_names.end() && name->second == handle)
+	{
+		m_names.erase(name);
+	}
+	m_slots[handle.index].gen = (m_slots[handle.index].gen == UINT32_MAX) ? 1 : m_slots[handle.index].gen + 1;
+	m_freeSlots.push_back(handle.index);
+
+	// Keep arrays dense, move the last entity into the hole
+	size_t last = size() - 1;
+	if (i != last)
+	{
+		m_pva[i] = m_pva[last];
+		m_transform[i] = m_transform[last];
+		m_size[i] = m_size[last];
+		m_aabb[i] = m_aabb[last];
+		m_state[i] = m_state[last];
+		m_time[i] = m_time[last];
+		m_health[i] = m_health[last];
+		m_ctrl[i] = m_ctrl[last];
+		m_controller[i] = m_controller[last];
+		m_facing[i] = m_facing[last];
+		m_reload[i] = m_reload[last];
+		m_props[i] = m_props[last];
+		m_sprite[i] = m_sprite[last];
+		m_slotOf[i] = m_slotOf[last];
+		m_slots[m_slotOf[i]].dense = static_cast<uint32_t>(i);
+	}
+
+	m_pva.pop_back();
+	m_transform.pop_back();
+	m_size.pop_back();
+	m_aabb.pop_back();
+	m_state.pop_back();
+	m_time.pop_back();
+	m_health.pop_back();
+	m_ctrl.pop_back();
+	m_controller.pop_back();
+	m_facing.pop_back();
+	m_reload.pop_back();
+	m_props.pop_back();
+	m_sprite.pop_back();
+	m_slotOf.pop_back();
+}
+
+size_t World::chunks() const
+{
+	return (size() + WORLD_CHUNK - 1) / WORLD_CHUNK;
+}
+
+size_t World::size() const
+{
+	return m_pva.size();
+}
+
+bool World::valid(EntityHandle handle) const
+{
+	return handle.index < m_slots.size() && m_slots[handle.index].gen == handle.gen;
+}
+
+size_t World::resolve(EntityHandle handle) const
+{
+	return valid(handle) ? m_slots[handle.index].dense : size();
+}
+
+EntityHandle World::handle(size_t i) const
+{
+	return EntityHandle(m_slotOf[i], m_slots[m_slotOf[i]].gen);
+}
+
+EntityHandle World::find(const std::string & name) const
+{
+	auto it = m_names.find(name);
+	if (it == m_names.end() || valid(it->second) == false)
+	{
+		return EntityHandle();
+	}
+
+	return it->second;
+}
+
+void World::bind(uint8_t controller, const std::map<int, std::string> & bind_map)
+{
+	static const std::map<std::string, uint32_t> ACTIONS = {
+		{ "left", CTRL_LEFT },
+		{ "right", CTRL_RIGHT },
+		{ "up", CTRL_UP },
+		{ "down", CTRL_DOWN },
+		{ "jump", CTRL_JUMP },
+		{ "fire", CTRL_FIRE },
+		{ "reload", CTRL_RELOAD },
+		{ "change", CTRL_CHANGE }
+	};
+
+	if (controller >= m_actions.size())
+	{
+		m_actions.resize(controller + 1, 0);
+	}
+
+	// Drop the controller's previous bindings
+	size_t n = 0;
+	for (size_t i = 0; i < m_bindKey.size(); i++)
+	{
+		if (m_bindController[i] == controller)
+			continue;
+
+		m_bindKey[n] = m_bindKey[i];
+		m_bindBit[n] = m_bindBit[i];
+		m_bindController[n] = m_bindController[i];
+		n++;
+	}
+	m_bindKey.resize(n);
+	m_bindBit.resize(n);
+	m_bindController.resize(n);
+
+	for (auto & kv : bind_map)
+	{
+		auto action = ACTIONS.find(kv.second);
+		if (action == ACTIONS.end())
+		{
+			mlibc_err("World::bind(%u). Unknown action '%s'!", controller, kv.second.c_str());
+			continue;
+		}
+
+		if (kv.first < 0 || static_cast<size_t>(kv.first) >= InputManager::KEY_COUNT)
+		{
+			mlibc_err("World::bind(%u). Scancode %d out of range!", controller, kv.first);
+			continue;
+		}
+
+		m_bindKey.push_back(static_cast<uint16_t>(kv.first));
+		m_bindBit.push_back(action->second);
+		m_bindController.push_back(controller);
+	}
+}
+
+void World::tick(float t, float dt)
+{
+	// Entity systems run in parallel over chunks, effects on shared state are deferred per chunk
+	size_t n_chunks = chunks();
+	if (m_commands.size() < n_chunks)
+	{
+		m_commands.resize(n_chunks);
+	}
+
+	JobManager::parallel_for(n_chunks, [this, dt](size_t c) {
+		size_t begin = c * WORLD_CHUNK;
+		size_t end = std::min(begin + WORLD_CHUNK, size());
+		std::vector<WorldCommand> & cmds = m_commands[c];
+
+		// Bracket the systems with the transforms the renderer lerps between
+		for (size_t i = begin; i < end; i++)
+		{
+			m_transform[i].prev = m_pva[i].pos;
+		}
+
+		bounds(begin, end);
+		respawn(begin, end, dt, cmds);
+		integrate(begin, end, dt);
+		control(begin, end);
+		weapons(begin, end, dt, cmds);
+
+		for (size_t i = begin; i < end; i++)
+		{
+			m_transform[i].curr = m_pva[i].pos;
+			m_time[i] += dt;
+		}
+	});
+
+	// Sync point, apply the deferred commands in chunk order so results do not depend on thread timing
+	for (size_t c = 0; c < n_chunks; c++)
+	{
+		execute(m_commands[c], dt);
+		m_commands[c].clear();
+	}
+
+	broadphase();
+	m_projectiles.tick(m_level, &m_grid, dt);
+	damage();
+}
+
+void World::edit()
+{
+	for (auto & cmd : m_edits)
+	{
+		m_level->alter(M_VOID, T_AIR, 24, static_cast<int>(cmd.pos.x), static_cast<int>(cmd.pos.y), true);
+		AudioManager::play_audio("ALIVE.SFX");
+	}
+	m_edits.clear();
+
+	m_projectiles.carve(m_level);
+}
+
+void World::animate(float t, float dt)
+{
+	JobManager::parallel_for(chunks(), [this, t, dt](size_t c) {
+		size_t begin = c * WORLD_CHUNK;
+		size_t end = std::min(begin + WORLD_CHUNK, size());
+
+		for (size_t i = begin; i < end; i++)
+		{
+			m_sprite[i].update(t, dt);
+		}
+	});
+}
+
+void World::render()
+{
+	for (size_t i = 0; i < size(); i++)
+	{
+		// Do not render when entity is dead
+		if (m_state[i] == ES_DEAD)
+			continue;
+
+		const Physics::Transform & tf = m_transform[i];
+		const Math::vec2 half = m_size[i] * 0.5f;
+
+		// Render sprite
+		m_sprite[i].render(
+			static_cast<int>(tf.prev.x - half.x),
+			static_cast<int>(tf.prev.y - half.y),
+			static_cast<int>(tf.curr.x - half.x),
+			static_cast<int>(tf.curr.y - half.y),
+			(m_state[i] == ES_SPAWNING) ? 90 : -1
+		);
+
+		// Render AABB, it is placed at the start of a tick so it moves by the tick's motion
+		(m_aabb[i] + (tf.curr - tf.prev)).render(m_aabb[i], 0, 255, 0, 64);
+	}
+
+	m_projectiles.render();
+}
+
+const Physics::PosVelAcc & World::getPVA(EntityHandle handle) const
+{
+	return m_pva[m_slots[handle.index].dense];
+}
+
+EntityState_t World::getState(EntityHandle handle) const
+{
+	return m_state[m_slots[handle.index].dense];
+}
+
+void World::setState(EntityHandle handle, EntityState_t state)
+{
+	m_state[m_slots[handle.index].dense] = state;
+}
+
+uint32_t World::getCtrl(EntityHandle handle) const
+{
+	return m_ctrl[m_slots[handle.index].dense];
+}
+
+float World::getHealth(EntityHandle handle) const
+{
+	return m_health[m_slots[handle.index].dense];
+}
+
+const std::string & World::getName(EntityHandle handle) const
+{
+	return m_props[m_slots[handle.index].dense].name;
+}
+
+Projectiles & World::getProjectiles()
+{
+	return m_projectiles;
+}
+
+SpatialGrid & World::getGrid()
+{
+	return m_grid;
+}
+
+const WorldAllocStats & World::getAllocStats() const
+{
+	return m_allocStats;
+}
+
+void World::resetAllocStats()
+{
+	m_allocStats.created = 0;
+	m_allocStats.destroyed = 0;
+	m_allocStats.heap = 0;
+}
+
+void World::reserve(size_t capacity)
+{
+	if (capacity <= m_capacity)
+		return;
+
+	m_pva.reserve(capacity);
+	m_transform.reserve(capacity);
+	m_size.reserve(capacity);
+	m_aabb.reserve(capacity);
+	m_state.reserve(capacity);
+	m_time.reserve(capacity);
+	m_health.reserve(capacity);
+	m_ctrl.reserve(capacity);
+	m_controller.reserve(capacity);
+	m_facing.reserve(capacity);
+	m_reload.reserve(capacity);
+	m_props.reserve(capacity);
+	m_sprite.reserve(capacity);
+	m_slots.reserve(capacity);
+	m_freeSlots.reserve(capacity);
+	m_slotOf.reserve(capacity);
+	m_query.reserve(capacity);
+
+	if (m_capacity > 0)
+	{
+		mlibc_dbg("World::reserve(%zu). Entity capacity exceeded, growing component arrays.", capacity);
+	}
+
+	m_capacity = capacity;
+	m_allocStats.heap++;
+}
+
+void World::input()
+{
+	// Resolve every binding once into per controller action bits
+	std::fill(m_actions.begin(), m_actions.end(), 0);
+	for (size_t b = 0; b < m_bindKey.size(); b++)
+	{
+		// Taps shorter than a tick still count for the tick they happened in
+		if (InputManager::KEYS[m_bindKey[b]] || InputManager::KEYS_PRESSED[m_bindKey[b]])
+		{
+			m_actions[m_bindController[b]] |= m_bindBit[b];
+		}
+	}
+}
+
+void World::control(size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		uint8_t controller = m_controller[i];
+		if (controller >= m_actions.size())
+			continue;
+
+		uint32_t bits = m_actions[controller];
+		m_ctrl[i] = bits;
+
+		// Facing follows the last horizontal input
+		if (bits & CTRL_LEFT)
+			m_facing[i] = -1.0f;
+		else if (bits & CTRL_RIGHT)
+			m_facing[i] = 1.0f;
+	}
+}
+
+void World::respawn(size_t begin, size_t end, float dt, std::vector<WorldCommand> & cmds)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		// Reset time if dead + trigger respawn, the random positions are picked at the sync point
+		if (m_state[i] == ES_DEAD)
+		{
+			m_time[i] = 0.0f;
+			m_state[i] = ES_SPAWNING;
+			cmds.push_back(WorldCommand{ WC_RESPAWN, static_cast<uint32_t>(i), m_pva[i].pos, Math::vec2() });
+			continue;
+		}
+
+		if (m_state[i] != ES_SPAWNING)
+			continue;
+
+		// Respawn process complete, spawn the entity + re-init
+		if (m_time[i] >= m_props[i].respawnTime)
+		{
+			m_state[i] = ES_ALIVE;
+			m_health[i] = m_props[i].health;
+
+			// Clear the level around the entity + play spawn audio
+			cmds.push_back(WorldCommand{ WC_SPAWNED, static_cast<uint32_t>(i), m_pva[i].pos, Math::vec2() });
+		}
+		// Respawn process incomplete, move towards spawn pos
+		else
+		{
+			m_pva[i].pos += (m_props[i].spawn - m_pva[i].pos) * dt;
+		}
+	}
+}
+
+void World::integrate(size_t begin, size_t end, float dt)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		if (m_state[i] != ES_ALIVE)
+			continue;
+
+		Physics::PosVelAcc & pva = m_pva[i];
+
+		// Simulate physics step
+		pva.pos = pva.pos + pva.vel * dt;
+
+		// Apply air friction
+		pva.vel -= pva.vel * 0.05f;
+
+		// Apply gravity force
+		pva.vel += Math::vec2(0.0f, -9.8f);
+	}
+}
+
+void World::weapons(size_t begin, size_t end, float dt, std::vector<WorldCommand> & cmds)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		if (m_reload[i] > 0.0f)
+			m_reload[i] -= dt;
+
+		if (m_state[i] != ES_ALIVE || (m_ctrl[i] & CTRL_FIRE) == 0 || m_reload[i] > 0.0f)
+			continue;
+
+		// Aim along facing, tilted by up/down
+		Math::vec2 dir(m_facing[i], 0.0f);
+		if (m_ctrl[i] & CTRL_UP)
+			dir.y += 1.0f;
+		if (m_ctrl[i] & CTRL_DOWN)
+			dir.y -= 1.0f;
+
+		cmds.push_back(WorldCommand{ WC_FIRE, static_cast<uint32_t>(i), m_pva[i].pos, dir.normalize() });
+		m_reload[i] = WEAPON_INTERVAL;
+	}
+}
+
+void World::execute(const std::vector<WorldCommand> & cmds, float dt)
+{
+	for (auto & cmd : cmds)
+	{
+		size_t i = cmd.entity;
+
+		switch (cmd.type)
+		{
+			case WC_RESPAWN:
+			{
+				// Move to random position on level + generate random final spawn pos
+				m_pva[i].pos = rng_vec2(m_level->getCfg().width, m_level->getCfg().height);
+				m_props[i].spawn = rng_vec2(m_level->getCfg().width, m_level->getCfg().height);
+
+				// First step towards the spawn pos
+				m_pva[i].pos += (m_props[i].spawn - m_pva[i].pos) * dt;
+				m_transform[i].curr = m_pva[i].pos;
+
+				// Teleport, nothing to interpolate from
+				m_transform[i].prev = m_transform[i].curr;
+			} break;
+			case WC_SPAWNED:
+			{
+				m_edits.push_back(cmd);
+			} break;
+			case WC_FIRE:
+			{
+				m_projectiles.spawn(WEAPON_PROJECTILE, cmd.pos, cmd.dir, handle(i));
+			} break;
+		}
+	}
+}
+
+void World::broadphase()
+{
+	// Only living entities can be hit, boxes are moved to where the tick left them
+	m_grid.clear();
+	for (size_t i = 0; i < size(); i++)
+	{
+		if (m_state[i] != ES_ALIVE)
+			continue;
+
+		m_grid.insert(handle(i), m_aabb[i] + (m_transform[i].curr - m_transform[i].prev));
+	}
+	m_grid.build();
+}
+
+void World::damage()
+{
+	for (auto & hit : m_projectiles.getHits())
+	{
+		// Direct hit
+		m_query.clear();
+		if (hit.target.isNull() == false)
+		{
+			m_query.push_back(hit.target);
+		}
+
+		// Splash around craters
+		if (hit.crater > 0)
+		{
+			m_grid.queryRadius(hit.hit.pos, hit.crater * 2.0f, m_query);
+		}
+
+		for (auto & target : m_query)
+		{
+			size_t i = resolve(target);
+			if (i >= size() || m_state[i] != ES_ALIVE)
+				continue;
+
+			m_health[i] -= hit.damage;
+			if (m_health[i] <= 0.0f)
+			{
+				m_state[i] = ES_DEAD;
+			}
+		}
+	}
+}
+
+void World::bounds(size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		const Math::vec2 half = m_size[i] * 0.5f;
+
+		m_aabb[i].setMinP(m_pva[i].pos - half);
+		m_aabb[i].setMaxP(m_pva[i].pos + half);
+	}
+}
\ No newline at end of file
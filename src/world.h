@@ -0,0 +1,206 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <cstdint>
+#include "math.h"
+#include "physics.h"
+#include "aabb.h"
+#include "sprite.h"
+#include "entity_handle.h"
+#include "projectiles.h"
+#include "spatial_grid.h"
+
+class Game;
+class Level;
+
+enum Entity_t : uint8_t
+{
+	E_PLAYER_OFFLINE = 0,
+	E_PLAYER_ONLINE = 1,
+	E_AI_OFFLINE = 2,
+	E_AI_ONLINE = 3
+};
+
+enum EntityState_t : uint8_t
+{
+	ES_DEAD = 0,
+	ES_SPAWNING = 1,
+	ES_ALIVE = 2
+};
+
+// Controller bits, one per action
+enum Control_t : uint32_t
+{
+	CTRL_LEFT = 1 << 0,
+	CTRL_RIGHT = 1 << 1,
+	CTRL_UP = 1 << 2,
+	CTRL_DOWN = 1 << 3,
+	CTRL_JUMP = 1 << 4,
+	CTRL_FIRE = 1 << 5,
+	CTRL_RELOAD = 1 << 6,
+	CTRL_CHANGE = 1 << 7
+};
+
+// Entities reserved up front, the component arrays only reach the heap past this
+#define WORLD_CAPACITY 256
+
+// Entity allocation counters, reset every frame by resetAllocStats()
+struct WorldAllocStats
+{
+	size_t created;										// entities created
+	size_t destroyed;									// entities destroyed
+	size_t heap;										// component array growths (heap allocations)
+};
+
+// Entities per job when systems run in parallel
+#define WORLD_CHUNK 64
+
+// Effects of the parallel systems on shared state (level, audio, RNG,
+// projectiles), recorded per chunk + applied at the sync point
+enum WorldCommand_t : uint8_t
+{
+	WC_RESPAWN = 0,										// pick random position + spawn point
+	WC_SPAWNED = 1,										// clear the level around pos, play audio (on edit())
+	WC_FIRE = 2											// spawn a projectile at pos along dir
+};
+
+struct WorldCommand
+{
+	WorldCommand_t type;
+	uint32_t entity;									// dense index
+	Math::vec2 pos;
+	Math::vec2 dir;
+};
+
+// No controller attached
+#define CONTROLLER_NONE 0xFF
+
+struct EntityProps
+{
+	Entity_t type;
+	std::string name;
+	Math::vec2 spawn;
+	float respawnTime;
+	EntityState_t state;
+	float health;
+};
+
+// Entity store; components live in dense arrays indexed by entity, systems
+// iterate them linearly. Entities are kept dense, destroy() moves the last
+// entity into the freed index, so outside code refers to entities by handle.
+// The arrays are reserved up front so creating entities does not allocate.
+// Systems run as jobs over chunks of entities, touching only their own.
+class World
+{
+public:
+	World(
+		Game * const game,
+		Level * level,
+		size_t capacity = WORLD_CAPACITY
+	);
+	~World();
+
+	// Entities, sprite instance is copied into the world
+	EntityHandle create(const EntityProps & props, const Sprite & sprite, uint8_t controller = CONTROLLER_NONE);
+	void destroy(EntityHandle handle);
+	size_t size() const;
+
+	// Handles
+	bool valid(EntityHandle handle) const;
+	size_t resolve(EntityHandle handle) const;			// dense index, size() when stale
+	EntityHandle handle(size_t i) const;
+	EntityHandle find(const std::string & name) const;	// name index for tooling, null when not found
+
+	// Controllers, binds scancodes to Control_t bits by action name ("left", "fire", ...)
+	void bind(uint8_t controller, const std::map<int, std::string> & bind_map);
+
+	// Systems
+	void input();										// resolve bound keys into controller actions
+	void tick(float t, float dt);						// controller, respawn + physics systems
+	void edit();										// apply the terrain edits deferred by tick()
+	void animate(float t, float dt);
+	void render();
+
+	// Component access, handle must be valid
+	const Physics::PosVelAcc & getPVA(EntityHandle handle) const;
+	EntityState_t getState(EntityHandle handle) const;
+	void setState(EntityHandle handle, EntityState_t state);
+	uint32_t getCtrl(EntityHandle handle) const;
+	float getHealth(EntityHandle handle) const;
+	const std::string & getName(EntityHandle handle) const;
+
+	// Projectiles fired by the entities
+	Projectiles & getProjectiles();
+
+	// Broadphase of the living entities, rebuilt every tick
+	SpatialGrid & getGrid();
+
+	// Allocation counters
+	const WorldAllocStats & getAllocStats() const;
+	void resetAllocStats();
+private:
+	void reserve(size_t capacity);
+
+	size_t chunks() const;
+	void control(size_t begin, size_t end);
+	void respawn(size_t begin, size_t end, float dt, std::vector<WorldCommand> & cmds);
+	void integrate(size_t begin, size_t end, float dt);
+	void bounds(size_t begin, size_t end);
+	void weapons(size_t begin, size_t end, float dt, std::vector<WorldCommand> & cmds);
+	void execute(const std::vector<WorldCommand> & cmds, float dt);
+	void broadphase();
+	void damage();
+
+	Game * const m_game;
+	Level * m_level;
+
+	// Hot components
+	std::vector<Physics::PosVelAcc> m_pva;
+	std::vector<Physics::Transform> m_transform;
+	std::vector<Math::vec2> m_size;						// sprite frame size, AABB extents
+	std::vector<AABB> m_aabb;
+	std::vector<EntityState_t> m_state;
+	std::vector<float> m_time;							// time in current state
+	std::vector<float> m_health;
+	std::vector<uint32_t> m_ctrl;						// Control_t bits
+	std::vector<uint8_t> m_controller;					// controller index or CONTROLLER_NONE
+	std::vector<float> m_facing;						// -1 left, 1 right
+	std::vector<float> m_reload;						// seconds until the weapon can fire again
+
+	// Cold components
+	std::vector<EntityProps> m_props;
+	std::vector<Sprite> m_sprite;
+
+	// Handle slots, slot -> dense index + generation, dense index -> slot
+	struct Slot
+	{
+		uint32_t dense;
+		uint32_t gen;
+	};
+	std::vector<Slot> m_slots;
+	std::vector<uint32_t> m_freeSlots;
+	std::vector<uint32_t> m_slotOf;
+	std::unordered_map<std::string, EntityHandle> m_names;
+
+	// Bindings of every controller compiled into one flat table, resolved once per tick
+	std::vector<uint16_t> m_bindKey;					// scancode
+	std::vector<uint32_t> m_bindBit;					// Control_t bit
+	std::vector<uint8_t> m_bindController;
+	std::vector<uint32_t> m_actions;					// per controller, Control_t bits held this tick
+
+	std::vector<std::vector<WorldCommand>> m_commands;	// deferred commands per chunk
+	std::vector<WorldCommand> m_edits;					// terrain edits deferred to edit()
+
+	Projectiles m_projectiles;
+	SpatialGrid m_grid;
+	std::vector<EntityHandle> m_query;					// scratch for grid queries
+
+	size_t m_capacity;
+	WorldAllocStats m_allocStats;
+};
+
+#endif // WORLD_H
\ No newline at end of file